@@ -0,0 +1,304 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "common/json/scanner.hpp"
+#include "message.hpp"
+
+namespace phemex
+{
+// Typed views of the account-order-position stream of the authenticated
+// session. Strings are views into the raw message and live as long as it.
+// Amounts keep the scaled integers of the api: Ev values, Ep prices and Er
+// ratios.
+
+struct AccountUpdate
+{
+  std::string_view currency;
+  int64_t account_id       = 0;
+  int64_t balance_ev       = 0;
+  int64_t used_balance_ev  = 0;
+  int64_t bonus_balance_ev = 0;
+};
+
+struct OrderUpdate
+{
+  std::string_view symbol;
+  std::string_view order_id;
+  std::string_view cl_ord_id;
+  std::string_view side;
+  std::string_view ord_type;
+  std::string_view time_in_force;
+  std::string_view ord_status;
+  std::string_view exec_status;
+  int64_t price_ep   = 0;
+  int64_t order_qty  = 0;
+  int64_t leaves_qty = 0;
+  int64_t cum_qty    = 0;
+  // fill carried by this update, 0 quantity if none
+  std::string_view exec_id;
+  int64_t exec_qty         = 0;
+  int64_t exec_price_ep    = 0;
+  int64_t exec_fee_ev      = 0;
+  int64_t exec_seq         = 0;
+  int64_t transact_time_ns = 0;
+};
+
+struct PositionUpdate
+{
+  std::string_view symbol;
+  std::string_view currency;
+  std::string_view side;
+  int64_t size                 = 0;
+  int64_t avg_entry_price_ep   = 0;
+  int64_t mark_price_ep        = 0;
+  int64_t liquidation_price_ep = 0;
+  int64_t value_ev             = 0;
+  int64_t position_margin_ev   = 0;
+  int64_t cum_closed_pnl_ev    = 0;
+  int64_t leverage_er          = 0;
+  int64_t transact_time_ns     = 0;
+};
+
+// Decoders of one array element, return its size for ForEachObject()
+inline std::size_t DecodeAccount(
+    std::string_view object, AccountUpdate& account)
+{
+  using namespace common::json;
+
+  return ForEachField(
+      object, [&](std::string_view key, std::string_view value) {
+        if ("currency" == key)
+        {
+          AsString(value, account.currency);
+        }
+        else if ("accountID" == key)
+        {
+          AsInteger(value, account.account_id);
+        }
+        else if ("accountBalanceEv" == key)
+        {
+          AsInteger(value, account.balance_ev);
+        }
+        else if ("totalUsedBalanceEv" == key)
+        {
+          AsInteger(value, account.used_balance_ev);
+        }
+        else if ("bonusBalanceEv" == key)
+        {
+          AsInteger(value, account.bonus_balance_ev);
+        }
+      });
+}
+
+inline std::size_t DecodeOrder(std::string_view object, OrderUpdate& order)
+{
+  using namespace common::json;
+
+  return ForEachField(
+      object, [&](std::string_view key, std::string_view value) {
+        if ("symbol" == key)
+        {
+          AsString(value, order.symbol);
+        }
+        else if ("orderID" == key)
+        {
+          AsString(value, order.order_id);
+        }
+        else if ("clOrdID" == key)
+        {
+          AsString(value, order.cl_ord_id);
+        }
+        else if ("side" == key)
+        {
+          AsString(value, order.side);
+        }
+        else if ("ordType" == key)
+        {
+          AsString(value, order.ord_type);
+        }
+        else if ("timeInForce" == key)
+        {
+          AsString(value, order.time_in_force);
+        }
+        else if ("ordStatus" == key)
+        {
+          AsString(value, order.ord_status);
+        }
+        else if ("execStatus" == key)
+        {
+          AsString(value, order.exec_status);
+        }
+        else if ("priceEp" == key)
+        {
+          AsInteger(value, order.price_ep);
+        }
+        else if ("orderQty" == key)
+        {
+          AsInteger(value, order.order_qty);
+        }
+        else if ("leavesQty" == key)
+        {
+          AsInteger(value, order.leaves_qty);
+        }
+        else if ("cumQty" == key)
+        {
+          AsInteger(value, order.cum_qty);
+        }
+        else if ("execID" == key)
+        {
+          AsString(value, order.exec_id);
+        }
+        else if ("execQty" == key)
+        {
+          AsInteger(value, order.exec_qty);
+        }
+        else if ("execPriceEp" == key)
+        {
+          AsInteger(value, order.exec_price_ep);
+        }
+        else if ("execFeeEv" == key)
+        {
+          AsInteger(value, order.exec_fee_ev);
+        }
+        else if ("execSeq" == key)
+        {
+          AsInteger(value, order.exec_seq);
+        }
+        else if ("transactTimeNs" == key)
+        {
+          AsInteger(value, order.transact_time_ns);
+        }
+      });
+}
+
+inline std::size_t DecodePosition(
+    std::string_view object, PositionUpdate& position)
+{
+  using namespace common::json;
+
+  return ForEachField(
+      object, [&](std::string_view key, std::string_view value) {
+        if ("symbol" == key)
+        {
+          AsString(value, position.symbol);
+        }
+        else if ("currency" == key)
+        {
+          AsString(value, position.currency);
+        }
+        else if ("side" == key)
+        {
+          AsString(value, position.side);
+        }
+        else if ("size" == key)
+        {
+          AsInteger(value, position.size);
+        }
+        else if ("avgEntryPriceEp" == key)
+        {
+          AsInteger(value, position.avg_entry_price_ep);
+        }
+        else if ("markPriceEp" == key)
+        {
+          AsInteger(value, position.mark_price_ep);
+        }
+        else if ("liquidationPriceEp" == key)
+        {
+          AsInteger(value, position.liquidation_price_ep);
+        }
+        else if ("valueEv" == key)
+        {
+          AsInteger(value, position.value_ev);
+        }
+        else if ("positionMarginEv" == key)
+        {
+          AsInteger(value, position.position_margin_ev);
+        }
+        else if ("cumClosedPnlEv" == key)
+        {
+          AsInteger(value, position.cum_closed_pnl_ev);
+        }
+        else if ("leverageEr" == key)
+        {
+          AsInteger(value, position.leverage_er);
+        }
+        else if ("transactTimeNs" == key)
+        {
+          AsInteger(value, position.transact_time_ns);
+        }
+      });
+}
+
+enum class AopType
+{
+  kSnapshot,
+  kIncremental
+};
+
+struct AopMessage
+{
+  AopType type      = AopType::kIncremental;
+  int64_t sequence  = -1;
+  int64_t timestamp = 0;
+  std::vector<AccountUpdate> accounts;
+  std::vector<OrderUpdate> orders;
+  std::vector<PositionUpdate> positions;
+};
+
+// Decode an aop message without building a json DOM: one pass over the
+// fields of the message, then one over the fields of every array element.
+// The vectors of aop are reused, returns false if the message is not an aop
+// one.
+inline bool DecodeAop(std::string_view message, AopMessage& aop)
+{
+  using namespace common::json;
+
+  if (!IsAop(message))
+  {
+    return false;
+  }
+
+  aop.type      = AopType::kIncremental;
+  aop.sequence  = -1;
+  aop.timestamp = 0;
+  aop.accounts.clear();
+  aop.orders.clear();
+  aop.positions.clear();
+  ForEachField(message, [&aop](std::string_view key, std::string_view value) {
+    if ("accounts" == key)
+    {
+      ForEachObject(value, [&aop](std::string_view object) {
+        return DecodeAccount(object, aop.accounts.emplace_back());
+      });
+    }
+    else if ("orders" == key)
+    {
+      ForEachObject(value, [&aop](std::string_view object) {
+        return DecodeOrder(object, aop.orders.emplace_back());
+      });
+    }
+    else if ("positions" == key)
+    {
+      ForEachObject(value, [&aop](std::string_view object) {
+        return DecodePosition(object, aop.positions.emplace_back());
+      });
+    }
+    else if ("sequence" == key)
+    {
+      AsInteger(value, aop.sequence);
+    }
+    else if ("timestamp" == key)
+    {
+      AsInteger(value, aop.timestamp);
+    }
+    else if ("type" == key && "\"snapshot\"" == value)
+    {
+      aop.type = AopType::kSnapshot;
+    }
+  });
+  return true;
+}
+
+} // namespace phemex
@@ -0,0 +1,109 @@
+// Cost of decoding an account-order-position incremental carrying a fill:
+// a nlohmann json DOM read into the same fields, against DecodeAop() walking
+// the fields of the raw message once.
+//
+// usage: aop_decode [iterations]
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "aop.hpp"
+
+using namespace phemex;
+
+namespace
+{
+const std::string kMessage{
+    R"({"accounts":[{"accountBalanceEv":9992165,"accountID":9328670003,)"
+    R"("bonusBalanceEv":0,"currency":"BTC","totalUsedBalanceEv":960,)"
+    R"("userID":932867}],"orders":[{"accountID":9328670003,"action":"New",)"
+    R"("actionBy":"ByUser","actionTimeNs":1580533011677666800,)"
+    R"("addedSeq":1110523464,"clOrdID":"a1b2c3d4-0001","closedPnlEv":0,)"
+    R"("closedSize":0,"code":0,"cumQty":1,"cumValueEv":1072,)"
+    R"("curAccBalanceEv":9992165,"curPosSide":"Buy","curPosSize":1,)"
+    R"("cxlRejReason":0,"displayQty":1,"execFeeEv":-3,)"
+    R"("execID":"b5b3b1a6-6a46-5c38-9bb5-8a4cdbd0f7a4",)"
+    R"("execPriceEp":93200000,"execQty":1,"execSeq":1110523464,)"
+    R"("execStatus":"MakerFill","execValueEv":1072,"feeRateEr":-25000,)"
+    R"("leavesQty":0,"leavesValueEv":0,"message":"No error",)"
+    R"("ordStatus":"Filled","ordType":"Limit",)"
+    R"("orderID":"9cb95282-7840-42d6-9768-ab8901385a67","orderQty":1,)"
+    R"("priceEp":93200000,"side":"Buy","stopPxEp":0,"symbol":"BTCUSD",)"
+    R"("timeInForce":"GoodTillCancel","tradeType":"Trade",)"
+    R"("transactTimeNs":1580533011677666800,"userID":932867}],)"
+    R"("positions":[{"accountID":9328670003,"avgEntryPriceEp":93200000,)"
+    R"("cumClosedPnlEv":0,"currency":"BTC","leverageEr":0,)"
+    R"("liquidationPriceEp":100000000,"markPriceEp":93200000,)"
+    R"("positionMarginEv":1072,"side":"Buy","size":1,"symbol":"BTCUSD",)"
+    R"("transactTimeNs":1580533011677666800,"valueEv":1072}],)"
+    R"("sequence":1167852,"timestamp":1580533011698569300,)"
+    R"("type":"incremental"})"};
+
+// The fields DecodeAop() reads, through a DOM
+int64_t DomDecode(const std::string& message)
+{
+  const auto json = nlohmann::json::parse(message);
+  int64_t sum     = json["sequence"].get<int64_t>();
+  for (const auto& order : json["orders"])
+  {
+    sum += order["execQty"].get<int64_t>() +
+           order["execPriceEp"].get<int64_t>() +
+           order["leavesQty"].get<int64_t>() +
+           static_cast<int64_t>(order["orderID"].get<std::string>().size());
+  }
+  for (const auto& position : json["positions"])
+  {
+    sum += position["size"].get<int64_t>();
+  }
+  return sum;
+}
+
+template <class F>
+double NanosPerCall(std::size_t iterations, F&& decode)
+{
+  // keeps the calls from being optimized away
+  volatile int64_t sink = 0;
+  const auto start      = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i)
+  {
+    sink = sink + decode();
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>{elapsed}.count() /
+         iterations;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const std::size_t iterations = argc > 1 ? std::stoul(argv[1]) : 100000;
+
+  AopMessage aop;
+  if (!DecodeAop(kMessage, aop) || 1 != aop.orders.size() ||
+      1 != aop.orders[0].exec_qty || 93200000 != aop.orders[0].exec_price_ep ||
+      1 != aop.positions.size() || 1167852 != aop.sequence)
+  {
+    std::cerr << "decoded fields differ" << std::endl;
+    return 1;
+  }
+
+  for (int run = 0; run < 3; ++run)
+  {
+    const auto dom = NanosPerCall(iterations, [] {
+      return DomDecode(kMessage);
+    });
+    const auto flat = NanosPerCall(iterations, [&aop] {
+      DecodeAop(kMessage, aop);
+      const auto& order = aop.orders[0];
+      return aop.sequence + order.exec_qty + order.exec_price_ep +
+             order.leaves_qty + static_cast<int64_t>(order.order_id.size()) +
+             aop.positions[0].size;
+    });
+    std::cout << "json DOM: " << dom << "ns, DecodeAop: " << flat
+              << "ns per message (" << kMessage.size() << " bytes)\n";
+  }
+  return 0;
+}
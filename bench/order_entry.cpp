@@ -0,0 +1,160 @@
+// Cost of turning an order into signed request bytes on the calling thread:
+// a json body dumped by nlohmann into a beast request with the signed
+// headers, then serialized as the connection would write it, against the
+// order template patched in place, alone and with the copy into the send
+// queue RestClient::PlaceOrder() makes (one allocation per order).
+//
+// usage: order_entry [iterations]
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <boost/beast/core/buffers_range.hpp>
+#include <boost/beast/http.hpp>
+#include <nlohmann/json.hpp>
+
+#include "common/crypto/hmac_signer.hpp"
+#include "order_template.hpp"
+
+using namespace phemex;
+namespace http = boost::beast::http;
+
+namespace
+{
+const std::string kHost{"api.phemex.com"};
+const std::string kApiKey{"8f5a7c2e-3d1b-4e6f-9a0c-b7d2e4f61a83"};
+const std::string kSecret{"c4f1dd0b-71a8-4a8e-b2c1-4e5dc2bd2a1e"};
+const std::string kPath{"/orders"};
+const int64_t kExpiry{1590000060};
+
+using Request = http::request<http::string_body>;
+
+Request BuildRequest(
+    const OrderRequest& order, common::crypto::HmacSigner& signer)
+{
+  nlohmann::json body{
+      {"actionBy", "FromOrderPlacement"},
+      {"symbol", order.symbol},
+      {"clOrdID", order.cl_ord_id},
+      {"side", ToString(order.side)},
+      {"orderQty", order.quantity},
+      {"ordType", ToString(order.type)},
+      {"timeInForce", ToString(order.time_in_force)},
+      {"reduceOnly", order.reduce_only},
+      {"priceEp", order.price_ep}};
+  const auto text   = body.dump();
+  const auto expiry = std::to_string(kExpiry);
+
+  common::crypto::HmacSigner::Signature signature;
+  const auto signed_text = signer.Sign(signature, kPath, expiry, text);
+
+  Request request{http::verb::post, kPath, 11};
+  request.set(http::field::host, kHost);
+  request.set(http::field::content_type, "application/json");
+  request.set("x-phemex-access-token", kApiKey);
+  request.set("x-phemex-request-expiry", expiry);
+  request.set(
+      "x-phemex-request-signature",
+      boost::beast::string_view{signed_text.data(), signed_text.size()});
+  request.keep_alive(true);
+  request.body() = text;
+  request.prepare_payload();
+  return request;
+}
+
+// Bytes of the request as async_write puts them on the wire
+std::string Serialize(Request& request)
+{
+  std::string wire;
+  http::request_serializer<http::string_body> serializer{request};
+  boost::system::error_code ec;
+  do
+  {
+    serializer.next(ec, [&](boost::system::error_code&, const auto& buffers) {
+      std::size_t size = 0;
+      for (const auto buffer : boost::beast::buffers_range_ref(buffers))
+      {
+        wire.append(static_cast<const char*>(buffer.data()), buffer.size());
+        size += buffer.size();
+      }
+      serializer.consume(size);
+    });
+  } while (!ec && !serializer.is_done());
+  return wire;
+}
+
+template <class F>
+double NanosPerCall(std::size_t iterations, F&& build)
+{
+  // keeps the calls from being optimized away
+  volatile std::size_t sink = 0;
+  const auto start          = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i)
+  {
+    sink = sink + build(i);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>{elapsed}.count() /
+         iterations;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const std::size_t iterations = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+  OrderRequest order;
+  order.symbol    = "BTCUSD";
+  order.cl_ord_id = "a1b2c3d4-0001";
+  order.side      = Side::kBuy;
+  order.price_ep  = 87700000;
+  order.quantity  = 10;
+
+  common::crypto::HmacSigner signer{kSecret};
+  OrderTemplate place{kHost, kApiKey, order};
+  place.Fill(order.cl_ord_id, order.price_ep, order.quantity, kExpiry, signer);
+
+  // same order either way, and the template signed over its own body
+  common::crypto::HmacSigner::Signature signature;
+  const auto expected = signer.Sign(
+      signature, kPath, std::to_string(kExpiry), std::string{place.Body()});
+  if (nlohmann::json::parse(place.Body()) !=
+          nlohmann::json::parse(BuildRequest(order, signer).body()) ||
+      std::string_view::npos == place.Wire().find(expected))
+  {
+    std::cerr << "template differs from the json request" << std::endl;
+    return 1;
+  }
+
+  for (int run = 0; run < 3; ++run)
+  {
+    const auto json = NanosPerCall(iterations, [&](std::size_t i) {
+      auto request = BuildRequest(order, signer);
+      return request.body().size() + i;
+    });
+    const auto wire = NanosPerCall(iterations, [&](std::size_t i) {
+      auto request = BuildRequest(order, signer);
+      return Serialize(request).size() + i;
+    });
+    const auto patched = NanosPerCall(iterations, [&](std::size_t i) {
+      return place
+          .Fill(
+              order.cl_ord_id, order.price_ep + static_cast<int64_t>(i & 0xff),
+              order.quantity, kExpiry, signer)
+          .size();
+    });
+    const auto queued = NanosPerCall(iterations, [&](std::size_t i) {
+      const std::string copy{place.Fill(
+          order.cl_ord_id, order.price_ep + static_cast<int64_t>(i & 0xff),
+          order.quantity, kExpiry, signer)};
+      return copy.size();
+    });
+    std::cout << "json request: " << json << "ns, serialized: " << wire
+              << "ns, template: " << patched << "ns, template copied: "
+              << queued << "ns per order (" << place.Wire().size()
+              << " bytes on the wire)\n";
+  }
+  return 0;
+}
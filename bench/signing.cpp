@@ -0,0 +1,93 @@
+// Cost of signing an order request: the naive way, concatenating the parts
+// and calling HMAC() with the key on every request, against the pre-keyed
+// signer writing into a stack buffer.
+//
+// usage: signing [iterations]
+
+#include <openssl/hmac.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "common/crypto/hmac_signer.hpp"
+
+using namespace phemex::common;
+
+namespace
+{
+const std::string kSecret{"c4f1dd0b-71a8-4a8e-b2c1-4e5dc2bd2a1e"};
+const std::string kPath{"/orders"};
+const std::string kExpiry{"1590000060"};
+const std::string kBody{
+    R"({"actionBy":"FromOrderPlacement","clOrdID":"a1b2c3d4-0001",)"
+    R"("orderQty":10,"ordType":"Limit","priceEp":87700000,)"
+    R"("reduceOnly":false,"side":"Buy","symbol":"BTCUSD",)"
+    R"("timeInForce":"GoodTillCancel"})"};
+
+std::string NaiveSign(std::string_view body)
+{
+  std::string message = kPath;
+  message.append(kExpiry);
+  message.append(body);
+
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int size = 0;
+  HMAC(
+      EVP_sha256(), kSecret.data(), static_cast<int>(kSecret.size()),
+      reinterpret_cast<const unsigned char*>(message.data()), message.size(),
+      digest, &size);
+
+  static constexpr char kHex[] = "0123456789abcdef";
+  std::string signature;
+  for (unsigned int i = 0; i < size; ++i)
+  {
+    signature.push_back(kHex[digest[i] >> 4]);
+    signature.push_back(kHex[digest[i] & 0x0f]);
+  }
+  return signature;
+}
+
+template <class F>
+double NanosPerCall(std::size_t iterations, F&& sign)
+{
+  // keeps the calls from being optimized away
+  volatile std::size_t sink = 0;
+  const auto start          = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i)
+  {
+    sink = sink + sign(i);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>{elapsed}.count() /
+         iterations;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const std::size_t iterations = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+  crypto::HmacSigner signer{kSecret};
+  crypto::HmacSigner::Signature signature;
+  if (NaiveSign(kBody) != signer.Sign(signature, kPath, kExpiry, kBody))
+  {
+    std::cerr << "signatures differ" << std::endl;
+    return 1;
+  }
+
+  for (int run = 0; run < 3; ++run)
+  {
+    const auto naive = NanosPerCall(iterations, [](std::size_t i) {
+      return static_cast<std::size_t>(NaiveSign(kBody)[i % 64]);
+    });
+    const auto keyed = NanosPerCall(iterations, [&](std::size_t i) {
+      return static_cast<std::size_t>(
+          signer.Sign(signature, kPath, kExpiry, kBody)[i % 64]);
+    });
+    std::cout << "naive HMAC(): " << naive << "ns, pre-keyed signer: " << keyed
+              << "ns per signature (" << kBody.size() << " byte body)\n";
+  }
+  return 0;
+}
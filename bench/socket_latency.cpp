@@ -0,0 +1,114 @@
+// Loopback round trip of small frames, each written as a header and a
+// payload like a framed protocol does, with the system default socket
+// options and with a low latency tuning profile.
+//
+// usage: socket_latency [rounds]
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include "common/config/socket_options.hpp"
+#include "common/net/socket_options.hpp"
+
+using boost::asio::ip::tcp;
+using namespace phemex::common;
+
+namespace
+{
+constexpr std::size_t kHeaderSize  = 4;
+constexpr std::size_t kPayloadSize = 60;
+constexpr std::size_t kFrameSize   = kHeaderSize + kPayloadSize;
+
+void WriteFrame(tcp::socket& socket, const char* frame)
+{
+  boost::asio::write(socket, boost::asio::buffer(frame, kHeaderSize));
+  boost::asio::write(
+      socket, boost::asio::buffer(frame + kHeaderSize, kPayloadSize));
+}
+
+void Echo(tcp::acceptor& acceptor, const config::SocketOptions& conf)
+{
+  auto socket = acceptor.accept();
+  net::ApplySocketOptions(socket, conf);
+
+  char frame[kFrameSize];
+  boost::system::error_code ec;
+  while (true)
+  {
+    boost::asio::read(socket, boost::asio::buffer(frame), ec);
+    if (ec)
+    {
+      return;
+    }
+    if (conf.quick_ack)
+    {
+      net::RearmQuickAck(socket);
+    }
+    WriteFrame(socket, frame);
+  }
+}
+
+void Run(const std::string& name, const config::SocketOptions& conf, int rounds)
+{
+  boost::asio::io_context ioc;
+  tcp::acceptor acceptor{ioc, {boost::asio::ip::address_v4::loopback(), 0}};
+  std::thread server{[&]() { Echo(acceptor, conf); }};
+
+  tcp::socket socket{ioc};
+  socket.connect(acceptor.local_endpoint());
+  net::ApplySocketOptions(socket, conf);
+  const auto report = net::GetSocketReport(socket);
+
+  char frame[kFrameSize] = {};
+  std::vector<std::chrono::nanoseconds> samples;
+  samples.reserve(rounds);
+  for (int i = 0; i < rounds; ++i)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    WriteFrame(socket, frame);
+    boost::asio::read(socket, boost::asio::buffer(frame));
+    if (conf.quick_ack)
+    {
+      net::RearmQuickAck(socket);
+    }
+    samples.push_back(std::chrono::steady_clock::now() - start);
+  }
+  socket.close();
+  server.join();
+
+  std::sort(samples.begin(), samples.end());
+  const auto percentile = [&](double p) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               samples[static_cast<std::size_t>(p * (samples.size() - 1))])
+        .count();
+  };
+  std::cout << name << ": rounds " << rounds << ", p50 " << percentile(0.5)
+            << "us, p99 " << percentile(0.99) << "us, max "
+            << percentile(1.0) << "us\n"
+            << report.ToString(1);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const auto rounds = argc > 1 ? std::stoi(argv[1]) : 100;
+
+  config::SocketOptions tuned;
+  tuned.no_delay       = true;
+  tuned.quick_ack      = true;
+  tuned.receive_buffer = 1 << 20;
+  tuned.send_buffer    = 1 << 20;
+  tuned.busy_poll      = 50;
+
+  Run("default", config::SocketOptions{}, rounds);
+  Run("tuned", tuned, rounds);
+  return 0;
+}
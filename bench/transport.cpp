@@ -0,0 +1,266 @@
+// Per message cost of the websocket client read and write paths against a
+// local tls server on another thread. Reports wall time and cpu time of the
+// client thread per message.
+//
+// usage: transport [messages] [runs]
+
+#include <time.h>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+
+#include "client.hpp"
+#include "common/net/self_signed_context.hpp"
+
+using boost::asio::ip::tcp;
+using namespace phemex::common;
+
+namespace
+{
+const std::string kMarketData{
+    R"({"book":{"asks":[[87705000,1000000]],"bids":[[87700000,2000000]]},)"
+    R"("depth":30,"sequence":123456789,"symbol":"BTCUSD",)"
+    R"("timestamp":1590000000000000000,"type":"incremental"})"};
+
+const std::string kRequest{
+    R"({"method":"order.place","params":["BTCUSD",1,87700000],"id":7})"};
+
+using Stream = boost::beast::websocket::stream<
+    boost::asio::ssl::stream<tcp::socket>>;
+
+// Streams market data after a subscription, counts every other request
+class Server
+{
+ public:
+  explicit Server(std::size_t messages)
+    : messages_{messages},
+      context_{net::MakeSelfSignedContext()},
+      acceptor_{ioc_, {boost::asio::ip::address_v4::loopback(), 0}}
+  {
+    boost::asio::spawn(
+        ioc_, [this](boost::asio::yield_context yield) { Accept(yield); });
+    thread_ = std::thread{[this]() { ioc_.run(); }};
+  }
+
+  ~Server()
+  {
+    ioc_.stop();
+    thread_.join();
+  }
+
+  inline auto Port() const
+  {
+    return acceptor_.local_endpoint().port();
+  }
+
+  // invoked on the server thread once all requests arrived
+  std::function<void()> on_received;
+
+ private:
+  void Accept(boost::asio::yield_context yield)
+  {
+    while (true)
+    {
+      boost::system::error_code ec;
+      tcp::socket socket{ioc_};
+      acceptor_.async_accept(socket, yield[ec]);
+      if (ec)
+      {
+        return;
+      }
+      boost::asio::spawn(
+          ioc_, [this, socket = std::move(socket)](
+                    boost::asio::yield_context yield) mutable {
+            Session(std::move(socket), yield);
+          });
+    }
+  }
+
+  void Session(tcp::socket socket, boost::asio::yield_context yield)
+  {
+    boost::system::error_code ec;
+    Stream ws{std::move(socket), context_};
+    ws.next_layer().async_handshake(
+        boost::asio::ssl::stream_base::server, yield[ec]);
+    if (!ec)
+    {
+      ws.async_accept(yield[ec]);
+    }
+
+    boost::beast::flat_buffer buffer;
+    std::size_t received = 0;
+    while (!ec)
+    {
+      ws.async_read(buffer, yield[ec]);
+      const auto message = boost::beast::buffers_to_string(buffer.data());
+      buffer.consume(buffer.size());
+      if (ec || message.find("server.ping") != std::string::npos)
+      {
+        continue;
+      }
+
+      if (message.find("subscribe") != std::string::npos)
+      {
+        for (std::size_t i = 0; i < messages_ && !ec; ++i)
+        {
+          ws.async_write(boost::asio::buffer(kMarketData), yield[ec]);
+        }
+      }
+      else if (++received == messages_ && on_received)
+      {
+        on_received();
+      }
+    }
+  }
+
+ private:
+  std::size_t messages_;
+  boost::asio::io_context ioc_;
+  boost::asio::ssl::context context_;
+  tcp::acceptor acceptor_;
+  std::thread thread_;
+};
+
+struct Cost
+{
+  double wall = 0;
+  double cpu  = 0;
+};
+
+inline std::chrono::nanoseconds ThreadCpuTime()
+{
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+
+// Measures the client thread between Begin() and End()
+class Stopwatch
+{
+ public:
+  inline void Begin()
+  {
+    wall_ = std::chrono::steady_clock::now();
+    cpu_  = ThreadCpuTime();
+  }
+
+  inline Cost End(std::size_t messages) const
+  {
+    const auto wall = std::chrono::duration<double, std::nano>{
+        std::chrono::steady_clock::now() - wall_};
+    const auto cpu =
+        std::chrono::duration<double, std::nano>{ThreadCpuTime() - cpu_};
+    return {wall.count() / messages, cpu.count() / messages};
+  }
+
+ private:
+  std::chrono::steady_clock::time_point wall_;
+  std::chrono::nanoseconds cpu_;
+};
+
+config::WebsocketClient MakeConfig(const Server& server, std::size_t messages)
+{
+  config::WebsocketClient conf;
+  conf.addr = config::HostAddress{"wss://127.0.0.1:" +
+                                  std::to_string(server.Port())};
+  conf.write_queue_size = static_cast<uint32_t>(messages);
+  return conf;
+}
+
+// Time from the first to the last streamed message
+Cost ReadPath(std::size_t messages)
+{
+  Server server{messages};
+  boost::asio::io_context ioc{1};
+
+  Stopwatch stopwatch;
+  Cost cost;
+  std::size_t received = 0;
+  phemex::Client client{
+      ioc, MakeConfig(server, messages), [&](std::string) {
+        if (0 == received++)
+        {
+          stopwatch.Begin();
+        }
+        else if (messages == received)
+        {
+          cost = stopwatch.End(messages - 1);
+          ioc.stop();
+        }
+      }};
+  client.SubscribeTrade("BTCUSD");
+  ioc.run();
+  return cost;
+}
+
+// Time from queueing a burst of requests until the server read them all
+Cost WritePath(std::size_t messages)
+{
+  Server server{messages};
+  boost::asio::io_context ioc{1};
+
+  Stopwatch stopwatch;
+  Cost cost;
+  server.on_received = [&]() {
+    boost::asio::post(ioc, [&]() {
+      cost = stopwatch.End(messages);
+      ioc.stop();
+    });
+  };
+
+  phemex::Client client{
+      ioc, MakeConfig(server, messages), [](std::string) {}};
+  boost::asio::steady_timer timer{ioc};
+  std::function<void(const boost::system::error_code&)> burst =
+      [&](const boost::system::error_code&) {
+        if (!client.IsAvailable())
+        {
+          timer.expires_after(std::chrono::milliseconds{10});
+          timer.async_wait(burst);
+          return;
+        }
+        stopwatch.Begin();
+        for (std::size_t i = 0; i < messages; ++i)
+        {
+          client.Write(kRequest);
+        }
+      };
+  burst({});
+  ioc.run();
+  return cost;
+}
+
+template <class F>
+void Run(const std::string& name, F&& path, std::size_t messages, int runs)
+{
+  Cost best{1e18, 1e18};
+  for (int i = 0; i < runs; ++i)
+  {
+    const auto cost = path(messages);
+    best.wall       = std::min(best.wall, cost.wall);
+    best.cpu        = std::min(best.cpu, cost.cpu);
+  }
+  std::cout << name << ": " << best.wall << "ns wall, " << best.cpu
+            << "ns cpu per message\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  const std::size_t messages = argc > 1 ? std::stoul(argv[1]) : 100000;
+  const int runs             = argc > 2 ? std::stoi(argv[2]) : 3;
+
+  boost::log::core::get()->set_logging_enabled(false);
+  Run("read ", ReadPath, messages, runs);
+  Run("write", WritePath, messages, runs);
+  return 0;
+}
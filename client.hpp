@@ -1,10 +1,26 @@
 #pragma once
 
-#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <stdexcept>
 
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "common/chrono/latency.hpp"
+#include "common/chrono/time.hpp"
+#include "aop.hpp"
 #include "common/config/websocket_client.hpp"
+#include "common/crypto/hmac_signer.hpp"
 #include "common/net/tcp/websocket/client.hpp"
 #include "common/timer.hpp"
+#include "message.hpp"
+#include "request.hpp"
+#include "subscription.hpp"
 
 namespace phemex
 {
@@ -12,111 +28,451 @@ class Client : public common::net::tcp::websocket::Client<Client>
 {
   using WebsocketClient = common::net::tcp::websocket::Client<Client>;
 
+  static constexpr std::size_t kChannels =
+      static_cast<std::size_t>(Channel::kAop) + 1;
+
  public:
+  using AopCallback  = std::function<void(const AopMessage&)>;
+  using AuthCallback = std::function<void(bool authenticated)>;
+
   Client(
-      boost::asio::io_context& ioc,
+      boost::asio::io_context& ioc, const common::config::WebsocketClient& conf,
       std::function<void(std::string)> ws_msg_callback)
-    : WebsocketClient{ioc, common::config::WebsocketClient{}},
-      heartbeat_timer_{ioc, 5},
-      ws_msg_callback_{ws_msg_callback}
+    : WebsocketClient{ioc, conf},
+      heartbeat_timer_{WebsocketClient::Strand(), 5},
+      ws_msg_callback_{ws_msg_callback},
+      subscribe_timer_{ioc},
+      subscribe_interval_{
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>{conf.subscribe_interval})},
+      subscribe_batch_{std::max<uint32_t>(conf.subscribe_batch, 1)},
+      latency_(conf.record_latency ? kChannels : 0),
+      estimate_clock_offset_{conf.estimate_clock_offset},
+      api_key_{conf.api_key},
+      auth_expiry_{static_cast<int64_t>(conf.auth_expiry)},
+      auth_timeout_{
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>{conf.auth_timeout})},
+      auth_timer_{ioc}
   {
+    if (!api_key_.empty())
+    {
+      if (conf.api_secret.empty())
+      {
+        throw std::invalid_argument{"websocket auth needs an api secret"};
+      }
+      signer_.emplace(conf.api_secret);
+    }
     heartbeat_timer_.Start([this]() { SendHearbeat(); });
   }
 
+  Client(
+      boost::asio::io_context& ioc,
+      std::function<void(std::string)> ws_msg_callback)
+    : Client{ioc, common::config::WebsocketClient{}, ws_msg_callback}
+  {
+  }
+
+  // Stop the heartbeat and the pending subscription batch with the
+  // connection
+  inline void Stop()
+  {
+    boost::asio::post(WebsocketClient::Strand(), [this]() {
+      heartbeat_timer_.Stop();
+      subscribe_timer_.cancel();
+      auth_timer_.cancel();
+    });
+    WebsocketClient::Stop();
+  }
+
   inline void SendHearbeat()
   {
     if (WebsocketClient::IsAvailable())
     {
-      WebsocketClient::Write(nlohmann::json{
-          {"method", "server.ping"},
-          {"params", {}},
-          {"id", 0}}.dump());
+      ping_sent_ = std::chrono::steady_clock::now();
+      WebsocketClient::Write(Frames::Ping(), common::net::Lane::kHeartbeat);
     }
   }
 
+  // Request timed by the endpoint prober
+  inline const std::string& ProbeRequest() const
+  {
+    return Frames::Ping();
+  }
+
+  // `{"error":null,"id":0,"result":"pong"}`, market data is never that short
+  inline bool IsProbeReply(std::string_view message) const
+  {
+    return message.size() < 64 &&
+           message.find("\"pong\"") != std::string_view::npos;
+  }
+
   inline void SubscribeOrderBook(const std::string& symbol)
   {
     BOOST_LOG(client_lg) << "subscribe order book, symbol: " << symbol;
-    subs_.push_back(nlohmann::json{
-        {"method", "orderbook.subscribe"},
-        {"params", {symbol}},
-        {"id", 1}}.dump());
+    Subscribe(Channel::kOrderBook, symbol);
   }
 
   inline void SubscribeKline(const std::string& symbol, int32_t interval)
   {
     BOOST_LOG(client_lg) << "subscribe kline, symbol: " << symbol
                          << ", interval: " << interval;
-    subs_.push_back(nlohmann::json{
-        {"method", "kline.subscribe"},
-        {"params", {symbol, interval}},
-        {"id", 2}}.dump());
+    Subscribe(Channel::kKline, symbol, interval);
   }
 
   inline void SubscribeTrade(const std::string& symbol)
   {
     BOOST_LOG(client_lg) << "subscribe trade, symbol: " << symbol;
-    subs_.push_back(nlohmann::json{
-        {"method", "trade.subscribe"},
-        {"params", {symbol}},
-        {"id", 3}}.dump());
+    Subscribe(Channel::kTrade, symbol);
+  }
+
+  // Account, order and position snapshot then incrementals of the api key,
+  // requested once user.auth succeeds on every connection. Not requested on
+  // a connection whose auth failed, see OnAuth().
+  inline void SubscribeAop()
+  {
+    if (!signer_)
+    {
+      throw std::invalid_argument{"aop subscription needs an api key"};
+    }
+    BOOST_LOG(client_lg) << "subscribe aop";
+    Subscribe(Channel::kAop, "");
+  }
+
+  // Aop messages decoded go to the callback instead of the message callback
+  inline void OnAop(AopCallback callback)
+  {
+    boost::asio::post(
+        WebsocketClient::Strand(),
+        [this, callback = std::move(callback)]() mutable {
+          aop_callback_ = std::move(callback);
+        });
+  }
+
+  // Outcome of user.auth on every connection, false if rejected or not
+  // replied within auth_timeout
+  inline void OnAuth(AuthCallback callback)
+  {
+    boost::asio::post(
+        WebsocketClient::Strand(),
+        [this, callback = std::move(callback)]() mutable {
+          auth_callback_ = std::move(callback);
+        });
   }
 
   inline void UnsubscribeOrderBook()
   {
     BOOST_LOG(client_lg) << "unsubscribe all order book";
-    subs_.push_back(nlohmann::json{
-        {"method", "orderbook.unsubscribe"},
-        {"params", {}},
-        {"id", 4}}.dump());
+    Unsubscribe(Channel::kOrderBook);
   }
 
   inline void UnsubscribeKline()
   {
     BOOST_LOG(client_lg) << "unsubscribe all kline";
-    subs_.push_back(nlohmann::json{
-        {"method", "kline.unsubscribe"},
-        {"params", {}},
-        {"id", 5}}.dump());
+    Unsubscribe(Channel::kKline);
   }
 
   inline void UnsubscribeTrade()
   {
     BOOST_LOG(client_lg) << "unsubscribe all trade";
-    subs_.push_back(nlohmann::json{
-        {"method", "trade.unsubscribe"},
-        {"params", {}},
-        {"id", 6}}.dump());
+    Unsubscribe(Channel::kTrade);
+  }
+
+  inline void UnsubscribeAop()
+  {
+    BOOST_LOG(client_lg) << "unsubscribe aop";
+    Unsubscribe(Channel::kAop);
+  }
+
+  // user.auth succeeded on the current connection, read on the thread of
+  // the client
+  inline bool Authenticated() const
+  {
+    return authenticated_;
+  }
+
+  // Subscriptions and their state, read on the thread of the client
+  inline const auto& Subscriptions() const
+  {
+    return subs_.Subscriptions();
   }
 
   inline void Parse(std::string_view remote_url, std::string&& message)
   {
     BOOST_LOG(client_lg) << "received message from " << remote_url
                          << ", message: " << message;
-    ws_msg_callback_(message);
+    using common::chrono::Time;
+
+    if (ping_sent_ && IsProbeReply(message))
+    {
+      const auto rtt = std::chrono::steady_clock::now() - *ping_sent_;
+      WebsocketClient::AddPingRtt(rtt);
+      if (estimate_clock_offset_)
+      {
+        Time::ExchangeOffset().AddRoundTrip(
+            std::chrono::nanoseconds{rtt}.count(),
+            Time::Now<std::chrono::nanoseconds>());
+      }
+      ping_sent_.reset();
+    }
+    if (!OnAuthReply(message))
+    {
+      subs_.OnReply(message);
+    }
+
+    if (latency_.empty() && !estimate_clock_offset_)
+    {
+      if (aop_callback_ && DecodeAop(message, aop_))
+      {
+        aop_callback_(aop_);
+        return;
+      }
+      ws_msg_callback_(message);
+      return;
+    }
+
+    auto times = WebsocketClient::ReadTimes();
+    MessageHeader header;
+    PeekHeader(message, header);
+    times.exchange   = header.timestamp;
+    const auto typed = Channel::kAop == header.channel && aop_callback_ &&
+                       DecodeAop(message, aop_);
+    times.decode = Time::Now<std::chrono::nanoseconds>();
+    if (typed)
+    {
+      aop_callback_(aop_);
+    }
+    else
+    {
+      ws_msg_callback_(message);
+    }
+    times.handle = Time::Now<std::chrono::nanoseconds>();
+
+    if (Channel::kUnknown == header.channel)
+    {
+      return;
+    }
+
+    const auto arrival = 0 != times.receive ? times.receive : times.read;
+    if (0 != times.exchange && estimate_clock_offset_)
+    {
+      Time::ExchangeOffset().AddMessage(times.exchange, arrival);
+    }
+    if (!latency_.empty())
+    {
+      // measure against the exchange clock
+      times.Shift(Time::ExchangeOffset().Offset(arrival));
+      latency_[static_cast<std::size_t>(header.channel)].Record(times);
+    }
+  }
+
+  // Latency of the channel's messages, read on the thread of the client,
+  // throws if not recording latency
+  inline auto& Latency(Channel channel)
+  {
+    return latency_.at(static_cast<std::size_t>(channel));
   }
 
   inline void OnConnected()
   {
+    ping_sent_.reset();
     BOOST_LOG(client_lg) << "websocket connected, server: "
                          << WebsocketClient::RemoteUrl();
-    for (const auto& sub : subs_)
+    // replay the wanted set, a pending batch timer flushes at once
+    subs_.Reset();
+    subscribe_timer_.cancel();
+    // a migration switches sessions without OnClose()
+    authenticated_ = false;
+    auth_id_       = 0;
+    auth_timer_.cancel();
+    if (signer_)
     {
-      BOOST_LOG_SEV(client_lg, debug)
-          << "send subscription message, message: " << sub;
-      WebsocketClient::Write(sub);
+      Authenticate();
     }
+    SendSubscriptions();
   }
 
   inline void OnClose()
   {
+    ping_sent_.reset();
+    authenticated_ = false;
+    auth_id_       = 0;
+    auth_timer_.cancel();
     BOOST_LOG(client_lg) << "websocket closed, server: "
                          << WebsocketClient::RemoteUrl();
   }
 
  private:
-  common::DurationTimer<std::chrono::seconds> heartbeat_timer_;
+  inline void Subscribe(
+      Channel channel, const std::string& symbol, int32_t interval = 0)
+  {
+    boost::asio::post(
+        WebsocketClient::Strand(), [this, channel, symbol, interval]() {
+          subs_.Subscribe(channel, symbol, interval);
+          SendSubscriptions();
+        });
+  }
+
+  inline void Unsubscribe(Channel channel)
+  {
+    boost::asio::post(WebsocketClient::Strand(), [this, channel]() {
+      subs_.Unsubscribe(channel);
+      SendSubscriptions();
+    });
+  }
+
+  // `{"method":"user.auth","params":["API",key,signature,expiry],"id":..}`
+  // signed over key + expiry, ahead of everything else on the control lane.
+  // The session counts as not authenticated if no reply comes within
+  // auth_timeout.
+  inline void Authenticate()
+  {
+    const int64_t expiry =
+        common::chrono::Time::Now<std::chrono::seconds>() + auth_expiry_;
+    char digits[24];
+    const auto end =
+        std::to_chars(digits, digits + sizeof(digits), expiry).ptr;
+    common::crypto::HmacSigner::Signature signature;
+
+    auth_id_ = subs_.ReserveId();
+    const auto request =
+        auth_writer_.Begin("user.auth")
+            .Param("API")
+            .Param(api_key_)
+            .Param(signer_->Sign(
+                signature, api_key_,
+                std::string_view{
+                    digits, static_cast<std::size_t>(end - digits)}))
+            .Param(expiry)
+            .End(auth_id_);
+    BOOST_LOG(client_lg) << "authenticate websocket session, api key: "
+                         << api_key_;
+    WebsocketClient::Write(std::string{request}, common::net::Lane::kControl);
+
+    auth_timer_.expires_after(auth_timeout_);
+    auth_timer_.async_wait(boost::asio::bind_executor(
+        WebsocketClient::Strand(),
+        [this, id = auth_id_](const boost::system::error_code& ec) {
+          if (!ec && id == auth_id_)
+          {
+            auth_id_ = 0;
+            BOOST_LOG_SEV(client_lg, error)
+                << "websocket auth got no reply within "
+                << std::chrono::duration<double>{auth_timeout_}.count()
+                << "s, aop stays unsubscribed on this connection";
+            OnAuthenticated(false);
+          }
+        }));
+  }
+
+  // Take the reply of user.auth, aop.subscribe is held until it arrives so
+  // it follows an authenticated session. False if the message is not that
+  // reply.
+  inline bool OnAuthReply(std::string_view message)
+  {
+    using namespace common::json;
+
+    int64_t id = 0;
+    if (0 == auth_id_ || !IsReply(message) ||
+        !GetInteger(message, "id", id) || id != auth_id_)
+    {
+      return false;
+    }
+
+    auth_id_ = 0;
+    auth_timer_.cancel();
+    const bool authenticated =
+        0 == FindValue(message, "error").rfind("null", 0);
+    if (authenticated)
+    {
+      BOOST_LOG(client_lg) << "websocket session authenticated";
+    }
+    else
+    {
+      BOOST_LOG_SEV(client_lg, error)
+          << "websocket auth failed, aop stays unsubscribed on this "
+             "connection, reply: "
+          << message;
+    }
+    OnAuthenticated(authenticated);
+    return true;
+  }
+
+  inline void OnAuthenticated(bool authenticated)
+  {
+    authenticated_ = authenticated;
+    if (auth_callback_)
+    {
+      auth_callback_(authenticated);
+    }
+    SendSubscriptions();
+  }
+
+  // Send a batch of the queued subscription requests, the rest follow one
+  // batch per subscribe_interval. Queued requests wait for a connection,
+  // aop ones for an authenticated session.
+  inline void SendSubscriptions()
+  {
+    if (subscribing_ || !WebsocketClient::IsAvailable())
+    {
+      return;
+    }
+
+    const auto held = authenticated_ ? Channel::kUnknown : Channel::kAop;
+    for (uint32_t i = 0; i < subscribe_batch_ && subs_.HasNext(held); ++i)
+    {
+      const auto request = subs_.Next(held);
+      if (request.empty())
+      {
+        break;
+      }
+      BOOST_LOG_SEV(client_lg, debug)
+          << "send subscription message, message: " << request;
+      WebsocketClient::Write(
+          std::string{request}, common::net::Lane::kBulk);
+    }
+    if (!subs_.HasNext(held))
+    {
+      return;
+    }
+
+    subscribing_ = true;
+    subscribe_timer_.expires_after(subscribe_interval_);
+    subscribe_timer_.async_wait(boost::asio::bind_executor(
+        WebsocketClient::Strand(), [this](const boost::system::error_code&) {
+          subscribing_ = false;
+          SendSubscriptions();
+        }));
+  }
+
+ private:
+  // fires on the strand, ping_sent_ is also read by Parse()
+  common::DurationTimer<
+      std::chrono::seconds, boost::asio::io_context::strand>
+      heartbeat_timer_;
   std::function<void(std::string)> ws_msg_callback_;
-  std::vector<std::string> subs_;
+  SubscriptionManager subs_;
+  boost::asio::steady_timer subscribe_timer_;
+  std::chrono::steady_clock::duration subscribe_interval_;
+  uint32_t subscribe_batch_;
+  bool subscribing_ = false;
+  std::optional<std::chrono::steady_clock::time_point> ping_sent_;
+  // indexed by channel
+  std::vector<common::chrono::StageLatency> latency_;
+  bool estimate_clock_offset_;
+  std::string api_key_;
+  int64_t auth_expiry_;
+  std::chrono::steady_clock::duration auth_timeout_;
+  boost::asio::steady_timer auth_timer_;
+  // hmac-sha256 of api key + expiry, set if the session authenticates
+  std::optional<common::crypto::HmacSigner> signer_;
+  RequestWriter auth_writer_;
+  // id of the user.auth request waiting for its reply, 0 if none
+  int64_t auth_id_    = 0;
+  bool authenticated_ = false;
+  AuthCallback auth_callback_;
+  AopCallback aop_callback_;
+  // reused by every decoded aop message
+  AopMessage aop_;
 };
 } // namespace phemex
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <mutex>
+
+namespace phemex::common::chrono
+{
+// Estimate of the exchange clock relative to the local clock. A message
+// stamped by the exchange arrives after its one-way delay, so the smallest
+// `local - exchange` of a window belongs to the fastest message; half of the
+// smallest round trip of the window stands for its delay. Consecutive
+// windows give the drift. Fed from any thread, read lock-free.
+class ClockOffset
+{
+ public:
+  static constexpr int64_t kUnknown = std::numeric_limits<int64_t>::max();
+
+  struct Estimate
+  {
+    // local time of the estimate, nanoseconds since epoch
+    int64_t anchor = 0;
+    // exchange clock minus local clock at the anchor
+    int64_t offset = 0;
+    // nanoseconds the offset moves per second
+    double drift = 0;
+    // the offset is within +-error, kUnknown without a round trip
+    int64_t error = kUnknown;
+    bool valid    = false;
+
+    inline int64_t At(int64_t local) const
+    {
+      return offset + static_cast<int64_t>(drift * (local - anchor) / 1e9);
+    }
+  };
+
+  explicit ClockOffset(
+      std::chrono::nanoseconds window = std::chrono::seconds{10},
+      double smoothing                = 0.2)
+    : window_{window.count()}, smoothing_{smoothing}, version_{0}
+  {
+  }
+
+  ClockOffset(const ClockOffset&) = delete;
+  ClockOffset& operator=(const ClockOffset&) = delete;
+
+  // A message stamped by the exchange and received at the local time, both
+  // nanoseconds since epoch. Samples are dropped while another thread feeds,
+  // a min filter does not need all of them.
+  inline void AddMessage(int64_t exchange, int64_t local)
+  {
+    std::unique_lock<std::mutex> lock{mutex_, std::try_to_lock};
+    if (!lock)
+    {
+      return;
+    }
+
+    Roll(local);
+    if (local - exchange < window_delay_)
+    {
+      window_delay_ = local - exchange;
+      // keep a first estimate until the first window closes
+      if (!anchored_)
+      {
+        Publish(local, Candidate(), 0);
+      }
+    }
+  }
+
+  // Round trip of a request to the exchange, e.g. server.ping
+  inline void AddRoundTrip(int64_t rtt, int64_t local)
+  {
+    std::unique_lock<std::mutex> lock{mutex_, std::try_to_lock};
+    if (!lock)
+    {
+      return;
+    }
+
+    Roll(local);
+    window_rtt_ = std::min(window_rtt_, rtt);
+  }
+
+  inline Estimate Current() const
+  {
+    Estimate estimate;
+    while (true)
+    {
+      const auto version = version_.load(std::memory_order_acquire);
+      if (version & 1)
+      {
+        continue;
+      }
+      estimate.anchor = anchor_.load(std::memory_order_relaxed);
+      estimate.offset = offset_.load(std::memory_order_relaxed);
+      estimate.drift  = drift_.load(std::memory_order_relaxed);
+      estimate.error  = error_.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (version == version_.load(std::memory_order_relaxed))
+      {
+        estimate.valid = 0 != version;
+        return estimate;
+      }
+    }
+  }
+
+  // exchange minus local clock at the local time, 0 before any sample
+  inline int64_t Offset(int64_t local) const
+  {
+    const auto estimate = Current();
+    return estimate.valid ? estimate.At(local) : 0;
+  }
+
+ private:
+  // exchange minus local clock from the fastest message of the window
+  inline int64_t Candidate() const
+  {
+    const auto rtt = kUnknown != window_rtt_ ? window_rtt_ : last_rtt_;
+    return -window_delay_ + (kUnknown != rtt ? rtt / 2 : 0);
+  }
+
+  inline int64_t Error() const
+  {
+    const auto rtt = kUnknown != window_rtt_ ? window_rtt_ : last_rtt_;
+    return kUnknown != rtt ? rtt / 2 : kUnknown;
+  }
+
+  // Close the window once it is over, the first window starts at the first
+  // sample
+  inline void Roll(int64_t local)
+  {
+    if (0 == window_start_)
+    {
+      window_start_ = local;
+    }
+    if (local - window_start_ < window_ || kUnknown == window_delay_)
+    {
+      return;
+    }
+
+    const auto offset = Candidate();
+    auto drift        = drift_.load(std::memory_order_relaxed);
+    if (anchored_ && local > anchor_local_)
+    {
+      const auto sample =
+          (offset - anchor_offset_) * 1e9 / (local - anchor_local_);
+      drift = drifted_ ? smoothing_ * sample + (1 - smoothing_) * drift
+                       : sample;
+      drifted_ = true;
+    }
+    Publish(local, offset, drift);
+    anchored_      = true;
+    anchor_local_  = local;
+    anchor_offset_ = offset;
+
+    if (kUnknown != window_rtt_)
+    {
+      last_rtt_ = window_rtt_;
+    }
+    window_rtt_   = kUnknown;
+    window_delay_ = kUnknown;
+    window_start_ = local;
+  }
+
+  inline void Publish(int64_t local, int64_t offset, double drift)
+  {
+    const auto version = version_.load(std::memory_order_relaxed);
+    version_.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    anchor_.store(local, std::memory_order_relaxed);
+    offset_.store(offset, std::memory_order_relaxed);
+    drift_.store(drift, std::memory_order_relaxed);
+    error_.store(Error(), std::memory_order_relaxed);
+    version_.store(version + 2, std::memory_order_release);
+  }
+
+ private:
+  const int64_t window_;
+  const double smoothing_;
+
+  // feeding state, guarded by the mutex
+  std::mutex mutex_;
+  int64_t window_start_  = 0;
+  int64_t window_delay_  = kUnknown;
+  int64_t window_rtt_    = kUnknown;
+  int64_t last_rtt_      = kUnknown;
+  bool anchored_         = false;
+  bool drifted_          = false;
+  int64_t anchor_local_  = 0;
+  int64_t anchor_offset_ = 0;
+
+  // published estimate, even version when consistent
+  std::atomic<uint64_t> version_;
+  std::atomic<int64_t> anchor_{0};
+  std::atomic<int64_t> offset_{0};
+  std::atomic<double> drift_{0};
+  std::atomic<int64_t> error_{kUnknown};
+};
+
+} // namespace phemex::common::chrono
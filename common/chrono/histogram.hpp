@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "common/config/utils.hpp"
+
+namespace phemex::common::chrono
+{
+// Log-linear histogram of non-negative integer values (nanoseconds) in the
+// manner of HdrHistogram: every power of two is split into 64 linear
+// sub-buckets, so a recorded value is reported within 1.6% of itself.
+// Values above 2^36 (about 68s) are clamped, negatives count as 0.
+class Histogram
+{
+ public:
+  static constexpr int kSubBucketBits      = 6;
+  static constexpr int kMaxBits            = 36;
+  static constexpr int64_t kSubBucketCount = int64_t{1} << kSubBucketBits;
+  static constexpr int64_t kMaxValue       = (int64_t{1} << kMaxBits) - 1;
+  static constexpr std::size_t kBucketCount =
+      (kMaxBits - kSubBucketBits + 1) * kSubBucketCount;
+
+  inline void Record(int64_t value)
+  {
+    value = std::clamp<int64_t>(value, 0, kMaxValue);
+    ++counts_[Index(value)];
+    ++count_;
+    total_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+  inline auto Count() const
+  {
+    return count_;
+  }
+
+  inline int64_t Min() const
+  {
+    return 0 == count_ ? 0 : min_;
+  }
+
+  inline int64_t Max() const
+  {
+    return max_;
+  }
+
+  inline double Mean() const
+  {
+    return 0 == count_ ? 0 : static_cast<double>(total_) / count_;
+  }
+
+  // Highest value equivalent to the recorded value at the percentile, in
+  // [0, 100]
+  inline int64_t Percentile(double percentile) const
+  {
+    if (0 == count_)
+    {
+      return 0;
+    }
+
+    const auto rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(percentile / 100 * count_ + 0.5));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBucketCount; ++i)
+    {
+      seen += counts_[i];
+      if (seen >= rank)
+      {
+        return std::min(HighestEquivalent(i), max_);
+      }
+    }
+    return max_;
+  }
+
+  inline void Merge(const Histogram& other)
+  {
+    for (std::size_t i = 0; i < kBucketCount; ++i)
+    {
+      counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    total_ += other.total_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+
+  inline void Reset()
+  {
+    *this = Histogram{};
+  }
+
+  inline auto ToString(const std::string& name, int32_t indent_chars = 0) const
+  {
+    using namespace config;
+    std::ostringstream oss;
+    PutHeader(oss, indent_chars, name);
+    PutLine(oss, indent_chars, "count", count_);
+    PutLine(oss, indent_chars, "min", Min());
+    PutLine(oss, indent_chars, "mean", Mean());
+    PutLine(oss, indent_chars, "p50", Percentile(50));
+    PutLine(oss, indent_chars, "p99", Percentile(99));
+    PutLine(oss, indent_chars, "p99.9", Percentile(99.9));
+    PutLine(oss, indent_chars, "max", max_);
+    return oss.str();
+  }
+
+ private:
+  static inline std::size_t Index(int64_t value)
+  {
+    if (value < kSubBucketCount)
+    {
+      return static_cast<std::size_t>(value);
+    }
+
+    // position of the highest bit decides the bucket, the next bits the
+    // linear sub-bucket
+    const auto shift =
+        63 - __builtin_clzll(static_cast<uint64_t>(value)) - kSubBucketBits;
+    return static_cast<std::size_t>(
+        (shift + 1) * kSubBucketCount + (value >> shift) - kSubBucketCount);
+  }
+
+  static inline int64_t HighestEquivalent(std::size_t index)
+  {
+    const auto i = static_cast<int64_t>(index);
+    if (i < kSubBucketCount)
+    {
+      return i;
+    }
+
+    const auto shift     = i / kSubBucketCount - 1;
+    const auto sub_value = i % kSubBucketCount + kSubBucketCount;
+    return ((sub_value + 1) << shift) - 1;
+  }
+
+ private:
+  std::array<uint64_t, kBucketCount> counts_{};
+  uint64_t count_ = 0;
+  int64_t total_  = 0;
+  int64_t min_    = std::numeric_limits<int64_t>::max();
+  int64_t max_    = 0;
+};
+
+} // namespace phemex::common::chrono
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include "common/chrono/histogram.hpp"
+
+namespace phemex::common::chrono
+{
+// Points in the life of one received message, nanoseconds since epoch of the
+// system clock, 0 if not taken
+struct MessageTimes
+{
+  // stamped by the exchange
+  int64_t exchange = 0;
+  // kernel receive time of the last segment read for the message
+  int64_t receive = 0;
+  // websocket read completed
+  int64_t read = 0;
+  // message header decoded
+  int64_t decode = 0;
+  // message callback returned
+  int64_t handle = 0;
+
+  // Move the local points onto the exchange clock
+  inline void Shift(int64_t offset)
+  {
+    for (auto* point : {&receive, &read, &decode, &handle})
+    {
+      if (0 != *point)
+      {
+        *point += offset;
+      }
+    }
+  }
+};
+
+// Histograms of the intervals between consecutive points of received
+// messages. Exchange based intervals are as good as the clock offset the local
+// points were shifted by.
+class StageLatency
+{
+ public:
+  inline void Record(const MessageTimes& times)
+  {
+    // wire: exchange to the first local point
+    const auto arrival = 0 != times.receive ? times.receive : times.read;
+    if (0 != times.exchange)
+    {
+      wire_.Record(arrival - times.exchange);
+      total_.Record(times.handle - times.exchange);
+    }
+    if (0 != times.receive)
+    {
+      read_.Record(times.read - times.receive);
+    }
+    decode_.Record(times.decode - times.read);
+    handle_.Record(times.handle - times.decode);
+  }
+
+  // exchange to kernel receive, or to read completion without kernel time
+  inline const auto& Wire() const
+  {
+    return wire_;
+  }
+
+  // kernel receive to read completion: wake-up, tls and websocket framing
+  inline const auto& Read() const
+  {
+    return read_;
+  }
+
+  inline const auto& Decode() const
+  {
+    return decode_;
+  }
+
+  inline const auto& Handle() const
+  {
+    return handle_;
+  }
+
+  // exchange to handler end, tick-to-handler
+  inline const auto& Total() const
+  {
+    return total_;
+  }
+
+  inline void Reset()
+  {
+    wire_.Reset();
+    read_.Reset();
+    decode_.Reset();
+    handle_.Reset();
+    total_.Reset();
+  }
+
+  inline auto ToString(const std::string& name, int32_t indent_chars = 0) const
+  {
+    using namespace config;
+    std::ostringstream oss;
+    PutHeader(oss, indent_chars, name);
+    oss << wire_.ToString("wire", indent_chars + 2)
+        << read_.ToString("read", indent_chars + 2)
+        << decode_.ToString("decode", indent_chars + 2)
+        << handle_.ToString("handle", indent_chars + 2)
+        << total_.ToString("total", indent_chars + 2);
+    return oss.str();
+  }
+
+ private:
+  Histogram wire_;
+  Histogram read_;
+  Histogram decode_;
+  Histogram handle_;
+  Histogram total_;
+};
+
+} // namespace phemex::common::chrono
@@ -4,6 +4,8 @@
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+#include "common/chrono/clock_offset.hpp"
+
 namespace phemex::common::chrono
 {
 class Time
@@ -15,6 +17,26 @@ class Time
     return NowImpl(Type<T...>{});
   }
 
+  // Exchange clock, the system clock corrected by the estimated offset
+  template <class... T>
+  static inline auto Exchange()
+  {
+    return ExchangeImpl(Type<T...>{});
+  }
+
+  // System clock nanoseconds since epoch to exchange clock
+  static inline int64_t ToExchange(int64_t local)
+  {
+    return local + ExchangeOffset().Offset(local);
+  }
+
+  // Process wide estimate, fed by clients with estimate_clock_offset set
+  static inline ClockOffset& ExchangeOffset()
+  {
+    static ClockOffset offset;
+    return offset;
+  }
+
  private:
   template <class... T>
   struct Type
@@ -34,6 +56,21 @@ class Time
   {
     return NowImpl(Type<std::chrono::duration<T...>>{});
   }
+
+  template <class... T>
+  static inline auto ExchangeImpl(const Type<std::chrono::duration<T...>>&)
+  {
+    const auto local = NowImpl(Type<std::chrono::nanoseconds>{});
+    return std::chrono::duration_cast<std::chrono::duration<T...>>(
+               std::chrono::nanoseconds{ToExchange(local)})
+        .count();
+  }
+
+  template <class... T>
+  static inline auto ExchangeImpl(const Type<T...>&)
+  {
+    return ExchangeImpl(Type<std::chrono::duration<T...>>{});
+  }
 };
 } // namespace phemex::common::chrono
 
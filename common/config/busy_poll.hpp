@@ -0,0 +1,16 @@
+#pragma once
+
+#include <exception>
+
+namespace phemex::common::config
+{
+struct BusyPoll
+{
+  // cpu core of the polling thread, negative is not pinned
+  int32_t cpu = -1;
+  // empty polls in a row before blocking until the next event, 0 never
+  // blocks and keeps the core busy
+  uint64_t spin_limit = 0;
+};
+
+} // namespace phemex::common::config
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <exception>
+#include <vector>
+
+namespace phemex::common::config
+{
+struct IOContextPool
+{
+  uint32_t threads = 1;
+  // cpu core of thread i, negative or missing entries are not pinned
+  std::vector<int32_t> cpus;
+  // poll the io_contexts in a loop instead of sleeping in epoll
+  bool busy_poll = false;
+  // see BusyPoll::spin_limit
+  uint64_t spin_limit = 0;
+};
+
+} // namespace phemex::common::config
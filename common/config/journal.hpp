@@ -0,0 +1,26 @@
+#pragma once
+
+#include <exception>
+#include <string>
+
+namespace phemex::common::config
+{
+struct Journal
+{
+  // directory of the segment files, empty disables capture
+  std::string directory;
+  // prefix of the segment file names, clients with the same directory and
+  // name share one journal
+  std::string name = "frames";
+  // bytes preallocated per segment file, a full segment rotates
+  uint64_t segment_size = 256ull << 20;
+  // bytes of the ring between each client and the writer thread, frames are
+  // dropped and counted while it is full
+  uint64_t ring_size = 16ull << 20;
+  // cpu core of the writer thread, negative is not pinned
+  int32_t cpu = -1;
+  // microseconds the writer sleeps once all rings are empty
+  int32_t idle_sleep = 100;
+};
+
+} // namespace phemex::common::config
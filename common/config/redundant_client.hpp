@@ -0,0 +1,21 @@
+#pragma once
+
+#include <exception>
+#include <vector>
+
+#include "common/config/websocket_client.hpp"
+
+namespace phemex::common::config
+{
+struct RedundantClient
+{
+  WebsocketClient websocket;
+  // feed i connects to endpoints[i % size], websocket.addr if empty
+  std::vector<HostAddress> endpoints;
+  uint32_t feeds = 2;
+  // a sequence this far below the last one of its stream means the exchange
+  // started the stream over
+  int64_t reset_gap = 10000;
+};
+
+} // namespace phemex::common::config
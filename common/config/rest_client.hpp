@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "common/config/host_address.hpp"
+#include "common/config/socket_options.hpp"
+
+namespace phemex::common::config
+{
+// Token bucket of one rate limit group of the rest api, refilled at capacity
+// requests per period
+struct RateLimit
+{
+  // name in the x-ratelimit-*-<group> response headers
+  std::string group = "contract";
+  uint32_t capacity = 5000;
+  // seconds
+  double period = 60;
+  // tokens only high priority requests, the order requests, may take
+  uint32_t reserve = 500;
+};
+
+struct RestClient
+{
+  HostAddress addr{"https://api.phemex.com"};
+  // tried after addr in order on reconnect
+  std::vector<HostAddress> fallback_addrs;
+  std::string api_key;
+  std::string api_secret;
+  // seconds a signed request stays valid at the server
+  double expiry = 60;
+  // keep-alive connections, all opened at start
+  uint32_t connections = 2;
+  // requests waiting for a free connection before new ones are rejected
+  uint32_t queue_size = 1024;
+  // seconds a request may wait for a connection, it then fails with
+  // timed_out, and seconds to wait for its response before the connection
+  // is dropped
+  double request_timeout    = 5;
+  double reconnect_interval = 1;
+  // seconds a connection may idle before it sends keep_alive_path to stay
+  // open, 0 sends nothing
+  double keep_alive_interval  = 30;
+  std::string keep_alive_path = "/public/time";
+  // seconds to keep resolved endpoints, 0 resolves on every connect
+  double dns_ttl  = 300;
+  bool enable_sni = true;
+  SocketOptions socket;
+  // groups without a limit here are not limited
+  std::vector<RateLimit> rate_limits{RateLimit{}};
+  // low priority requests waiting for tokens before new ones are rejected
+  uint32_t deferred_size = 256;
+  // seconds a low priority request may wait for a token, the ones expected
+  // to wait longer are rejected at once. Less than expiry.
+  double max_defer = 5;
+};
+
+} // namespace phemex::common::config
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <exception>
+
+#include "common/config/websocket_client.hpp"
+
+namespace phemex::common::config
+{
+struct ShardedClient
+{
+  WebsocketClient websocket;
+  uint32_t shards       = 4;
+  double rate_smoothing = 0.2;
+};
+
+} // namespace phemex::common::config
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <exception>
+
+namespace phemex::common::config
+{
+// Options applied to a tcp socket after connect, zero or negative values keep
+// the system defaults
+struct SocketOptions
+{
+  bool no_delay          = false;
+  int32_t receive_buffer = 0;
+  int32_t send_buffer    = 0;
+  // re-armed after every read, the kernel drops it on delayed ack
+  bool quick_ack = false;
+  // microseconds to busy poll the device queue on blocking reads
+  int32_t busy_poll = 0;
+  int32_t tos       = -1;
+  int32_t priority  = -1;
+  // kernel receive timestamps of read data (SO_TIMESTAMPING), reads then go
+  // through recvmsg()
+  bool rx_timestamps = false;
+};
+
+} // namespace phemex::common::config
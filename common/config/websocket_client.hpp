@@ -1,19 +1,73 @@
 #pragma once
 
 #include <exception>
+#include <string>
+#include <vector>
 
 #include "common/config/host_address.hpp"
+#include "common/config/journal.hpp"
+#include "common/config/socket_options.hpp"
 
 namespace phemex::common::config
 {
 struct WebsocketClient
 {
   HostAddress addr{"wss://ws.phemex.com"};
-  bool ssl                    = true;
-  int32_t timeout             = 30;
+  // tried after addr in order on reconnect
+  std::vector<HostAddress> fallback_addrs;
+  bool ssl = true;
+  // seconds without received data before the connection is dropped, 0 never
+  double timeout = 30;
+  // seconds between websocket pings, 0 sends none
+  double ping_interval        = 1;
   double reconnect_interval   = 1;
   int32_t response_size_limit = 0;
   bool enable_sni             = true;
+  // per write lane
+  uint32_t write_queue_size = 4096;
+  // serve the write lanes by weight instead of strictly by urgency
+  bool weighted_writes = false;
+  // messages per round of the control, heartbeat and bulk lanes
+  std::vector<uint32_t> write_weights{16, 4, 1};
+  // seconds to keep resolved endpoints, 0 resolves on every connect
+  double dns_ttl = 300;
+  // parallel connect attempts over resolved addresses and book entries,
+  // started every stagger seconds, 1 connects one address at a time
+  uint32_t connect_race_width = 1;
+  double connect_race_stagger = 0.25;
+  // seconds between latency probes of the book entries, 0 disables probing
+  // and reconnects rotate through the book in order
+  double probe_interval = 0;
+  double probe_timeout  = 5;
+  // weight of a new rtt sample in the smoothed value
+  double rtt_smoothing = 0.3;
+  // move to a probed endpoint once it is faster by this ratio
+  double migrate_hysteresis = 0.3;
+  // connections built ahead of the next connect, and the bytes of read
+  // buffer each allocates up front
+  uint32_t spare_connections = 1;
+  uint32_t read_buffer_size  = 64 * 1024;
+  // per channel latency histograms of received messages
+  bool record_latency = false;
+  // feed the process wide exchange clock estimate of chrono::Time with the
+  // message timestamps and ping round trips of this connection
+  bool estimate_clock_offset = false;
+  // subscription requests sent at once, the rest follow every interval
+  // seconds so replaying many after a reconnect stays within server limits
+  uint32_t subscribe_batch  = 10;
+  double subscribe_interval = 0.1;
+  // authenticate the session with user.auth once connected, needed by the
+  // account-order-position stream. Empty key stays anonymous.
+  std::string api_key;
+  std::string api_secret;
+  // seconds the signed auth request stays valid
+  double auth_expiry = 60;
+  // seconds to wait for the auth reply before the session is taken as not
+  // authenticated
+  double auth_timeout = 5;
+  // append every received frame to a binary journal
+  Journal journal;
+  SocketOptions socket;
 };
 
 } // namespace phemex::common::config
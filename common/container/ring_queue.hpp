@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+namespace phemex::common::container
+{
+// Bounded FIFO over a preallocated ring of slots, not thread safe. Elements
+// are moved in and stay in place until popped, so a reference to Front()
+// remains valid while other elements are pushed.
+template <class T>
+class RingQueue
+{
+ public:
+  explicit RingQueue(std::size_t capacity)
+    : slots_(RoundUp(capacity)), mask_{slots_.size() - 1}
+  {
+  }
+
+  inline bool Push(T&& value)
+  {
+    if (Full())
+    {
+      return false;
+    }
+    slots_[tail_++ & mask_] = std::move(value);
+    return true;
+  }
+
+  inline bool Push(const T& value)
+  {
+    if (Full())
+    {
+      return false;
+    }
+    slots_[tail_++ & mask_] = value;
+    return true;
+  }
+
+  inline T& Front()
+  {
+    return slots_[head_ & mask_];
+  }
+
+  inline void Pop()
+  {
+    slots_[head_++ & mask_] = T{};
+  }
+
+  inline bool Empty() const
+  {
+    return head_ == tail_;
+  }
+
+  inline bool Full() const
+  {
+    return tail_ - head_ == slots_.size();
+  }
+
+  inline std::size_t Size() const
+  {
+    return tail_ - head_;
+  }
+
+  inline std::size_t Capacity() const
+  {
+    return slots_.size();
+  }
+
+ private:
+  static inline std::size_t RoundUp(std::size_t capacity)
+  {
+    std::size_t size = 1;
+    while (size < capacity)
+    {
+      size <<= 1;
+    }
+    return size;
+  }
+
+ private:
+  std::vector<T> slots_;
+  std::size_t mask_;
+  std::size_t head_ = 0;
+  std::size_t tail_ = 0;
+};
+
+} // namespace phemex::common::container
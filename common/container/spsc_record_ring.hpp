@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+
+namespace phemex::common::container
+{
+// Lock-free ring of variable sized byte records between one producer thread
+// and one consumer thread. A record is a 4 byte size and its bytes, padded to
+// 8 bytes, and never wraps: a record that does not fit before the end of the
+// buffer is written at the front after a padding marker.
+class SpscRecordRing
+{
+ public:
+  explicit SpscRecordRing(std::size_t capacity)
+    : capacity_{RoundUp(capacity)},
+      mask_{capacity_ - 1},
+      buffer_{new (std::align_val_t{kLine}) char[capacity_]}
+  {
+  }
+
+  SpscRecordRing(const SpscRecordRing&) = delete;
+  SpscRecordRing& operator=(const SpscRecordRing&) = delete;
+
+  // Producer side: copy the parts into one record, false if it does not fit
+  // in the free space
+  inline bool Push(std::string_view head, std::string_view body)
+  {
+    const auto size = head.size() + body.size();
+    const auto need = Align(kPrefix + size);
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    auto pos        = tail & mask_;
+    const auto skip = capacity_ - pos < need ? capacity_ - pos : 0;
+    if (capacity_ - (tail - head_cache_) < skip + need)
+    {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (capacity_ - (tail - head_cache_) < skip + need)
+      {
+        return false;
+      }
+    }
+
+    if (0 != skip)
+    {
+      Store(pos, kPadding);
+      pos = 0;
+    }
+    Store(pos, static_cast<uint32_t>(size));
+    auto* data = &buffer_[pos + kPrefix];
+    std::memcpy(data, head.data(), head.size());
+    std::memcpy(data + head.size(), body.data(), body.size());
+    tail_.store(tail + skip + need, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side: visit the records pushed so far in order, their space is
+  // released once all are visited. Returns the number of records.
+  template <class F>
+  inline std::size_t Consume(F&& visitor)
+  {
+    auto head       = head_.load(std::memory_order_relaxed);
+    const auto tail = tail_.load(std::memory_order_acquire);
+    std::size_t records = 0;
+    while (head != tail)
+    {
+      const auto pos  = head & mask_;
+      const auto size = Load(pos);
+      if (kPadding == size)
+      {
+        head += capacity_ - pos;
+        continue;
+      }
+      visitor(std::string_view{&buffer_[pos + kPrefix], size});
+      head += Align(kPrefix + size);
+      ++records;
+    }
+    head_.store(head, std::memory_order_release);
+    return records;
+  }
+
+  inline bool Empty() const
+  {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+  inline std::size_t Capacity() const
+  {
+    return capacity_;
+  }
+
+ private:
+  static constexpr std::size_t kPrefix  = sizeof(uint32_t);
+  static constexpr uint32_t kPadding    = UINT32_MAX;
+  static constexpr std::size_t kLine    = 64;
+
+  struct Free
+  {
+    inline void operator()(char* buffer) const
+    {
+      ::operator delete[](buffer, std::align_val_t{kLine});
+    }
+  };
+
+  static inline std::size_t Align(std::size_t size)
+  {
+    return (size + 7) & ~std::size_t{7};
+  }
+
+  static inline std::size_t RoundUp(std::size_t capacity)
+  {
+    std::size_t size = kLine;
+    while (size < capacity)
+    {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  inline void Store(std::size_t pos, uint32_t value)
+  {
+    std::memcpy(&buffer_[pos], &value, sizeof(value));
+  }
+
+  inline uint32_t Load(std::size_t pos) const
+  {
+    uint32_t value;
+    std::memcpy(&value, &buffer_[pos], sizeof(value));
+    return value;
+  }
+
+ private:
+  const std::size_t capacity_;
+  const std::size_t mask_;
+  std::unique_ptr<char[], Free> buffer_;
+  // positions on separate cache lines, the producer's copy of the consumer
+  // position next to its own
+  alignas(kLine) std::atomic<std::size_t> head_{0};
+  alignas(kLine) std::atomic<std::size_t> tail_{0};
+  std::size_t head_cache_ = 0;
+};
+
+} // namespace phemex::common::container
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+namespace phemex::common::crypto
+{
+// Two lower case hex digits per byte value
+inline constexpr auto kHexPairs = []() {
+  constexpr char digits[] = "0123456789abcdef";
+  std::array<std::array<char, 2>, 256> pairs{};
+  for (std::size_t i = 0; i < pairs.size(); ++i)
+  {
+    pairs[i][0] = digits[i >> 4];
+    pairs[i][1] = digits[i & 0x0f];
+  }
+  return pairs;
+}();
+
+// Hex of size bytes into out, which holds 2 * size chars
+inline void HexEncode(const unsigned char* data, std::size_t size, char* out)
+{
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    std::memcpy(out + 2 * i, kHexPairs[data[i]].data(), 2);
+  }
+}
+
+// HMAC-SHA256 keyed once. The context keeps the digest states after the
+// inner and outer pads, every signature restarts from them instead of
+// hashing the key again, and nothing is allocated per signature. Not thread
+// safe, one signer per thread.
+class HmacSigner
+{
+ public:
+  static constexpr std::size_t kDigestSize = 32;
+  static constexpr std::size_t kHexSize    = 2 * kDigestSize;
+  using Signature                          = std::array<char, kHexSize>;
+
+  explicit HmacSigner(std::string_view key) : ctx_{HMAC_CTX_new()}
+  {
+    if (!ctx_ || 1 != HMAC_Init_ex(
+                          ctx_, key.data(), static_cast<int>(key.size()),
+                          EVP_sha256(), nullptr))
+    {
+      HMAC_CTX_free(ctx_);
+      throw std::runtime_error{"failed to key hmac-sha256 signer"};
+    }
+  }
+
+  HmacSigner(const HmacSigner&) = delete;
+  HmacSigner& operator=(const HmacSigner&) = delete;
+
+  ~HmacSigner()
+  {
+    HMAC_CTX_free(ctx_);
+  }
+
+  // Hex signature of the concatenated parts written to out, the view refers
+  // to out
+  template <class... Parts>
+  inline std::string_view Sign(Signature& out, const Parts&... parts)
+  {
+    // a null key and digest restart from the keyed pad states
+    HMAC_Init_ex(ctx_, nullptr, 0, nullptr, nullptr);
+    (Update(parts), ...);
+
+    unsigned char digest[kDigestSize];
+    unsigned int size = 0;
+    HMAC_Final(ctx_, digest, &size);
+    HexEncode(digest, kDigestSize, out.data());
+    return {out.data(), out.size()};
+  }
+
+ private:
+  inline void Update(std::string_view part)
+  {
+    HMAC_Update(
+        ctx_, reinterpret_cast<const unsigned char*>(part.data()),
+        part.size());
+  }
+
+ private:
+  HMAC_CTX* ctx_;
+};
+
+} // namespace phemex::common::crypto
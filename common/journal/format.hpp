@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace phemex::common::journal
+{
+// A segment file is a FileHeader followed by records back to back, the
+// preallocated tail is zero so a zero record size ends the segment. Integers
+// are in host byte order.
+struct FileHeader
+{
+  char magic[8]        = {'P', 'H', 'X', 'J', 'R', 'N', 'L', '\0'};
+  uint32_t version     = 1;
+  uint32_t header_size = sizeof(FileHeader);
+  // nanoseconds since epoch of the system clock
+  int64_t created = 0;
+
+  inline bool Valid() const
+  {
+    return 0 == std::memcmp(magic, FileHeader{}.magic, sizeof(magic)) &&
+           1 == version && sizeof(FileHeader) == header_size;
+  }
+};
+
+// Followed by the payload of one websocket message
+struct RecordHeader
+{
+  // bytes of the header and the payload
+  uint32_t size = 0;
+  // websocket::Connection::Id() of the receiving connection
+  uint32_t connection = 0;
+  // kernel receive time if taken, else read completion time, nanoseconds
+  // since epoch of the system clock
+  int64_t timestamp = 0;
+};
+
+static_assert(sizeof(FileHeader) == 24, "unexpected file header layout");
+static_assert(sizeof(RecordHeader) == 16, "unexpected record header layout");
+
+} // namespace phemex::common::journal
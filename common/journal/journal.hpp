@@ -0,0 +1,276 @@
+#pragma once
+
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "common/chrono/time.hpp"
+#include "common/config/journal.hpp"
+#include "common/container/spsc_record_ring.hpp"
+#include "common/journal/format.hpp"
+#include "common/journal/segment.hpp"
+#include "common/log.hpp"
+#include "common/thread/affinity.hpp"
+
+namespace phemex::common::journal
+{
+// Append-only capture of received frames. Each reading thread owns a Capture
+// whose Append() copies the frame into a ring, a writer thread moves the
+// records into mapped segment files and rotates them once full.
+class Journal
+{
+ public:
+  // Producer side of one ring, used by a single thread at a time
+  class Capture
+  {
+   public:
+    explicit Capture(std::size_t ring_size) : ring_{ring_size}, dropped_{0}
+    {
+    }
+
+    inline bool Append(
+        uint32_t connection, int64_t timestamp, std::string_view frame)
+    {
+      RecordHeader header;
+      header.size       = static_cast<uint32_t>(sizeof(header) + frame.size());
+      header.connection = connection;
+      header.timestamp  = timestamp;
+      if (!ring_.Push(
+              {reinterpret_cast<const char*>(&header), sizeof(header)}, frame))
+      {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      return true;
+    }
+
+    // frames lost to a full ring
+    inline uint64_t Dropped() const
+    {
+      return dropped_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    friend class Journal;
+    container::SpscRecordRing ring_;
+    std::atomic<uint64_t> dropped_;
+  };
+
+  explicit Journal(const config::Journal& conf)
+    : conf_{conf},
+      created_{chrono::Time::Now<std::chrono::nanoseconds>()},
+      stopped_{false},
+      version_{0},
+      records_{0},
+      bytes_{0},
+      dropped_{0}
+  {
+    if (conf_.directory.empty())
+    {
+      throw std::invalid_argument{"journal should have a directory"};
+    }
+    boost::filesystem::create_directories(conf_.directory);
+    Rotate();
+    thread_ = std::thread{[this]() { Run(); }};
+  }
+
+  Journal(const Journal&) = delete;
+  Journal& operator=(const Journal&) = delete;
+
+  // Writes out what the rings hold before returning
+  ~Journal()
+  {
+    stopped_.store(true, std::memory_order_release);
+    thread_.join();
+  }
+
+  // The journal of the directory and name, opened on first use and closed
+  // with its last user
+  static inline std::shared_ptr<Journal> Shared(const config::Journal& conf)
+  {
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<Journal>> journals;
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto& weak   = journals[conf.directory + "/" + conf.name];
+    auto journal  = weak.lock();
+    if (!journal)
+    {
+      journal = std::make_shared<Journal>(conf);
+      weak    = journal;
+    }
+    return journal;
+  }
+
+  // A ring for one more reading thread, released once the caller drops it
+  // and its records are written
+  inline std::shared_ptr<Capture> NewCapture()
+  {
+    auto capture = std::make_shared<Capture>(conf_.ring_size);
+    std::lock_guard<std::mutex> lock{mutex_};
+    captures_.push_back(capture);
+    version_.fetch_add(1, std::memory_order_release);
+    return capture;
+  }
+
+  inline uint64_t Records() const
+  {
+    return records_.load(std::memory_order_relaxed);
+  }
+
+  inline uint64_t Bytes() const
+  {
+    return bytes_.load(std::memory_order_relaxed);
+  }
+
+  // frames too large for a segment, or captured after a segment failed
+  inline uint64_t Dropped() const
+  {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void Run()
+  {
+    if (!thread::SetAffinity(conf_.cpu))
+    {
+      BOOST_LOG_SEV(client_lg, warning)
+          << "failed to pin journal writer to cpu " << conf_.cpu;
+    }
+
+    std::vector<std::shared_ptr<Capture>> captures;
+    uint64_t version = 0;
+    while (true)
+    {
+      // read the flag first so the last pass sees every record pushed
+      // before the stop
+      const auto stopped = stopped_.load(std::memory_order_acquire);
+      if (version != version_.load(std::memory_order_acquire))
+      {
+        std::lock_guard<std::mutex> lock{mutex_};
+        version  = version_.load(std::memory_order_relaxed);
+        captures = captures_;
+      }
+
+      std::size_t records = 0;
+      for (auto& capture : captures)
+      {
+        records += capture->ring_.Consume(
+            [this](std::string_view record) { Write(record); });
+      }
+
+      if (stopped)
+      {
+        break;
+      }
+      if (0 == records)
+      {
+        Release(captures);
+        std::this_thread::sleep_for(
+            std::chrono::microseconds{conf_.idle_sleep});
+      }
+    }
+    segment_.reset();
+  }
+
+  inline void Write(std::string_view record)
+  {
+    if (!segment_ || record.size() + sizeof(FileHeader) > conf_.segment_size)
+    {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (!segment_->Append(record))
+    {
+      try
+      {
+        Rotate();
+      }
+      catch (const std::exception& e)
+      {
+        BOOST_LOG_SEV(client_lg, error)
+            << "journal stops writing, reason: " << e.what();
+        segment_.reset();
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      segment_->Append(record);
+    }
+    records_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(record.size(), std::memory_order_relaxed);
+  }
+
+  // Close the full segment and open the next free
+  // <directory>/<name>-<utc start of the journal>-<index>.jrnl
+  inline void Rotate()
+  {
+    const auto seconds = static_cast<time_t>(created_ / 1000000000);
+    tm utc;
+    gmtime_r(&seconds, &utc);
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "-%Y%m%d-%H%M%S-", &utc);
+
+    std::string path;
+    do
+    {
+      char index[16];
+      std::snprintf(index, sizeof(index), "%06u.jrnl", index_++);
+      path = conf_.directory + "/" + conf_.name + stamp + index;
+    } while (boost::filesystem::exists(path));
+
+    segment_.reset();
+    segment_ = std::make_unique<Segment>(
+        path, conf_.segment_size,
+        chrono::Time::Now<std::chrono::nanoseconds>());
+    BOOST_LOG(client_lg) << "journal segment " << segment_->Path();
+  }
+
+  // Forget the drained rings of dropped captures
+  inline void Release(std::vector<std::shared_ptr<Capture>>& captures)
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    captures = captures_;
+    for (auto it = captures_.begin(); it != captures_.end();)
+    {
+      // held here, by the copy of the writer and by nobody else
+      if (2 == it->use_count() && (*it)->ring_.Empty())
+      {
+        it = captures_.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+    captures = captures_;
+  }
+
+ private:
+  config::Journal conf_;
+  const int64_t created_;
+  std::unique_ptr<Segment> segment_;
+  uint32_t index_ = 0;
+
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<Capture>> captures_;
+  std::atomic<bool> stopped_;
+  std::atomic<uint64_t> version_;
+
+  std::atomic<uint64_t> records_;
+  std::atomic<uint64_t> bytes_;
+  std::atomic<uint64_t> dropped_;
+  std::thread thread_;
+};
+
+} // namespace phemex::common::journal
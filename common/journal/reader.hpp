@@ -0,0 +1,135 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "common/journal/format.hpp"
+
+namespace phemex::common::journal
+{
+struct Record
+{
+  uint32_t connection = 0;
+  int64_t timestamp   = 0;
+  // refers to the mapped segment, valid while the reader lives
+  std::string_view frame;
+};
+
+// Sequential reader of one segment file, also of a segment still being
+// written or left behind by a crash
+class Reader
+{
+ public:
+  explicit Reader(const std::string& path) : path_{path}
+  {
+    const auto fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+      throw std::runtime_error{"failed to open journal segment " + path_ +
+                               ", reason: " + std::strerror(errno)};
+    }
+
+    struct stat st;
+    if (0 != ::fstat(fd, &st))
+    {
+      ::close(fd);
+      throw std::runtime_error{"failed to stat journal segment " + path_};
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+
+    if (size_ >= sizeof(FileHeader))
+    {
+      auto* data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+      if (MAP_FAILED != data)
+      {
+        data_ = static_cast<const char*>(data);
+      }
+    }
+    ::close(fd);
+
+    if (!data_)
+    {
+      throw std::runtime_error{"failed to map journal segment " + path_};
+    }
+    std::memcpy(&header_, data_, sizeof(header_));
+    if (!header_.Valid())
+    {
+      ::munmap(const_cast<char*>(data_), size_);
+      throw std::runtime_error{"not a journal segment " + path_};
+    }
+    pos_ = sizeof(FileHeader);
+  }
+
+  Reader(const Reader&) = delete;
+  Reader& operator=(const Reader&) = delete;
+
+  ~Reader()
+  {
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+
+  // Segment files of the journal name in the directory, oldest first
+  static inline std::vector<std::string> Segments(
+      const std::string& directory, const std::string& name)
+  {
+    std::vector<std::string> paths;
+    for (const auto& entry : boost::filesystem::directory_iterator{directory})
+    {
+      const auto file = entry.path().filename().string();
+      if (0 == file.rfind(name + "-", 0) && ".jrnl" == entry.path().extension())
+      {
+        paths.push_back(entry.path().string());
+      }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+  }
+
+  // Next record, false at the end of the segment
+  inline bool Next(Record& record)
+  {
+    RecordHeader header;
+    if (size_ - pos_ < sizeof(header))
+    {
+      return false;
+    }
+    std::memcpy(&header, data_ + pos_, sizeof(header));
+    if (header.size < sizeof(header) || size_ - pos_ < header.size)
+    {
+      return false;
+    }
+
+    record.connection = header.connection;
+    record.timestamp  = header.timestamp;
+    record.frame      = std::string_view{
+        data_ + pos_ + sizeof(header), header.size - sizeof(header)};
+    pos_ += header.size;
+    return true;
+  }
+
+  inline const auto& Header() const
+  {
+    return header_;
+  }
+
+ private:
+  std::string path_;
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+  std::size_t pos_  = 0;
+  FileHeader header_;
+};
+
+} // namespace phemex::common::journal
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "common/journal/format.hpp"
+
+namespace phemex::common::journal
+{
+// Segment file preallocated and mapped for writing. Data reaches the page
+// cache on memcpy and survives a crash of the process, not of the host.
+class Segment
+{
+ public:
+  Segment(const std::string& path, std::size_t size, int64_t created)
+    : path_{path}, size_{size}
+  {
+    if (size_ <= sizeof(FileHeader))
+    {
+      throw std::invalid_argument{"journal segment is too small"};
+    }
+
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0)
+    {
+      throw std::runtime_error{"failed to create journal segment " + path_ +
+                               ", reason: " + std::strerror(errno)};
+    }
+
+    const auto error = ::posix_fallocate(fd_, 0, static_cast<off_t>(size_));
+    if (0 != error)
+    {
+      ::close(fd_);
+      throw std::runtime_error{"failed to preallocate journal segment " +
+                               path_ + ", reason: " + std::strerror(error)};
+    }
+
+    // fault the pages in now rather than on the first write of each
+    auto* data = ::mmap(
+        nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+        0);
+    if (MAP_FAILED == data)
+    {
+      ::close(fd_);
+      throw std::runtime_error{"failed to map journal segment " + path_ +
+                               ", reason: " + std::strerror(errno)};
+    }
+    data_ = static_cast<char*>(data);
+
+    FileHeader header;
+    header.created = created;
+    std::memcpy(data_, &header, sizeof(header));
+    used_ = sizeof(header);
+  }
+
+  Segment(const Segment&) = delete;
+  Segment& operator=(const Segment&) = delete;
+
+  ~Segment()
+  {
+    Close();
+  }
+
+  // Copy a record in, false if it does not fit
+  inline bool Append(std::string_view record)
+  {
+    if (size_ - used_ < record.size())
+    {
+      return false;
+    }
+    std::memcpy(data_ + used_, record.data(), record.size());
+    used_ += record.size();
+    return true;
+  }
+
+  // Unmap and cut the unused preallocated tail
+  inline void Close()
+  {
+    if (fd_ < 0)
+    {
+      return;
+    }
+    ::munmap(data_, size_);
+    // a failed cut leaves the zero tail, still read as the end of segment
+    [[maybe_unused]] const auto cut =
+        ::ftruncate(fd_, static_cast<off_t>(used_));
+    ::close(fd_);
+    fd_ = -1;
+  }
+
+  inline const auto& Path() const
+  {
+    return path_;
+  }
+
+  inline std::size_t Used() const
+  {
+    return used_;
+  }
+
+ private:
+  std::string path_;
+  std::size_t size_;
+  std::size_t used_ = 0;
+  int fd_           = -1;
+  char* data_       = nullptr;
+};
+
+} // namespace phemex::common::journal
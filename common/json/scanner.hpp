@@ -0,0 +1,236 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+
+namespace phemex::common::json
+{
+// Light-weight accessors to pick flat fields out of a serialized json message
+// without building a DOM. Keys are searched as plain text, so they should be
+// unique in the scanned range.
+
+// Raw text of the value following `"key":`, empty if the key is not found
+inline std::string_view FindValue(std::string_view text, std::string_view key)
+{
+  std::size_t pos = 0;
+  while (true)
+  {
+    pos = text.find(key, pos);
+    if (std::string_view::npos == pos)
+    {
+      return {};
+    }
+
+    const auto begin = pos;
+    pos += key.size();
+    if (0 == begin || '"' != text[begin - 1] || pos >= text.size() ||
+        '"' != text[pos])
+    {
+      continue;
+    }
+
+    ++pos;
+    while (pos < text.size() && (' ' == text[pos] || ':' == text[pos]))
+    {
+      ++pos;
+    }
+    return text.substr(pos);
+  }
+}
+
+// Integer at the start of raw, e.g. a value FindValue() returned
+template <class T>
+inline bool AsInteger(std::string_view raw, T& value)
+{
+  return !raw.empty() &&
+         std::errc{} ==
+             std::from_chars(raw.data(), raw.data() + raw.size(), value).ec;
+}
+
+// String at the start of raw without unescaping, the view refers to raw
+inline bool AsString(std::string_view raw, std::string_view& value)
+{
+  if (raw.empty() || '"' != raw[0])
+  {
+    return false;
+  }
+
+  const auto end = raw.find('"', 1);
+  if (std::string_view::npos == end)
+  {
+    return false;
+  }
+  value = raw.substr(1, end - 1);
+  return true;
+}
+
+template <class T>
+inline bool GetInteger(std::string_view text, std::string_view key, T& value)
+{
+  return AsInteger(FindValue(text, key), value);
+}
+
+// String value without unescaping, the view refers to the scanned text
+inline bool GetString(
+    std::string_view text, std::string_view key, std::string_view& value)
+{
+  return AsString(FindValue(text, key), value);
+}
+
+inline bool HasKey(std::string_view text, std::string_view key)
+{
+  return !FindValue(text, key).empty();
+}
+
+// Index of the quote closing the string opened at raw[open], npos if none.
+// The search jumps from quote to quote, escaped ones are skipped.
+inline std::size_t StringEnd(std::string_view raw, std::size_t open)
+{
+  auto pos = raw.find('"', open + 1);
+  while (std::string_view::npos != pos)
+  {
+    auto slashes = pos;
+    while ('\\' == raw[slashes - 1])
+    {
+      --slashes;
+    }
+    if (0 == (pos - slashes) % 2)
+    {
+      return pos;
+    }
+    pos = raw.find('"', pos + 1);
+  }
+  return pos;
+}
+
+// Size of the object or array raw starts with, strings skipped, 0 if raw
+// does not start with one or it is not closed
+inline std::size_t EnclosedSize(std::string_view raw)
+{
+  if (raw.empty() || ('{' != raw[0] && '[' != raw[0]))
+  {
+    return 0;
+  }
+
+  int32_t depth = 0;
+  for (std::size_t i = 0; i < raw.size(); ++i)
+  {
+    switch (raw[i])
+    {
+    case '"':
+      i = StringEnd(raw, i);
+      if (std::string_view::npos == i)
+      {
+        return 0;
+      }
+      break;
+    case '{':
+    case '[':
+      ++depth;
+      break;
+    case '}':
+    case ']':
+      if (0 == --depth)
+      {
+        return i + 1;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  return 0;
+}
+
+// Size of the value raw starts with, quotes of a string included, 0 if it
+// is not closed
+inline std::size_t ValueSize(std::string_view raw)
+{
+  if (raw.empty())
+  {
+    return 0;
+  }
+  if ('{' == raw[0] || '[' == raw[0])
+  {
+    return EnclosedSize(raw);
+  }
+  if ('"' == raw[0])
+  {
+    const auto end = StringEnd(raw, 0);
+    return std::string_view::npos == end ? 0 : end + 1;
+  }
+  const auto end = raw.find_first_of(",}] \t\r\n");
+  return std::string_view::npos == end ? raw.size() : end;
+}
+
+// Call f(key, value) for every field of the object object starts with, in
+// one pass, value is the raw text of AsInteger() and AsString(). Returns the
+// size of the object, 0 if it is not closed. Cheaper than one FindValue()
+// per key once more than a few fields are wanted.
+template <class F>
+inline std::size_t ForEachField(std::string_view object, F&& f)
+{
+  if (object.empty() || '{' != object[0])
+  {
+    return 0;
+  }
+
+  std::size_t pos = 1;
+  while (true)
+  {
+    pos = object.find_first_of("\"}", pos);
+    if (std::string_view::npos == pos || '}' == object[pos])
+    {
+      return std::string_view::npos == pos ? 0 : pos + 1;
+    }
+    const auto end = object.find('"', pos + 1);
+    const auto key = object.substr(pos + 1, end - pos - 1);
+    pos            = object.find(':', end);
+    if (std::string_view::npos == end || std::string_view::npos == pos)
+    {
+      return 0;
+    }
+
+    ++pos;
+    while (pos < object.size() && ' ' == object[pos])
+    {
+      ++pos;
+    }
+    const auto size = ValueSize(object.substr(pos));
+    if (0 == size)
+    {
+      return 0;
+    }
+    f(key, object.substr(pos, size));
+    pos += size;
+  }
+}
+
+// Walk the objects of the array raw starts with: f gets the text from the
+// start of each object on and returns the object's size, e.g. the result of
+// ForEachField(), 0 stops the walk. Returns the number of objects.
+template <class F>
+inline std::size_t ForEachObject(std::string_view raw, F&& f)
+{
+  if (raw.empty() || '[' != raw[0])
+  {
+    return 0;
+  }
+
+  std::size_t count = 0;
+  auto pos          = raw.find_first_not_of(", \t\r\n", 1);
+  while (std::string_view::npos != pos && '{' == raw[pos])
+  {
+    const std::size_t size = f(raw.substr(pos));
+    if (0 == size)
+    {
+      break;
+    }
+    ++count;
+    pos = raw.find_first_not_of(", \t\r\n", pos + size);
+  }
+  return count;
+}
+
+} // namespace phemex::common::json
@@ -91,13 +91,33 @@ class AddressBook
     }
   }
 
-  inline void UseNext()
+  inline const auto& Current() const
   {
-    if (0 == book_.size())
+    return book_[index_];
+  }
+
+  inline const auto& At(std::size_t index) const
+  {
+    return book_.at(index);
+  }
+
+  inline std::size_t Size() const
+  {
+    return book_.size();
+  }
+
+  inline std::size_t Index() const
+  {
+    return index_;
+  }
+
+  inline void Use(std::size_t index)
+  {
+    if (index >= book_.size())
     {
       return;
     }
-    index_    = (index_ + 1) % book_.size();
+    index_    = index;
     protocol_ = book_[index_].protocol;
     host_     = book_[index_].host;
     port_     = book_[index_].port;
@@ -105,6 +125,15 @@ class AddressBook
     url_      = book_[index_].url;
   }
 
+  inline void UseNext()
+  {
+    if (0 == book_.size())
+    {
+      return;
+    }
+    Use((index_ + 1) % book_.size());
+  }
+
  protected:
   virtual ~AddressBook()
   {
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#include <boost/asio/io_context.hpp>
+
+#include "common/config/busy_poll.hpp"
+#include "common/log.hpp"
+#include "common/thread/affinity.hpp"
+
+namespace phemex::common::net
+{
+struct PollStats
+{
+  // polls without a ready handler
+  uint64_t spins  = 0;
+  uint64_t events = 0;
+  // falls back to a blocking wait after the spin limit
+  uint64_t blocks = 0;
+  // time between the last handler and the next one
+  std::chrono::nanoseconds idle{0};
+};
+
+// Run an io_context by polling it in a loop instead of sleeping in epoll, so
+// a ready socket is picked up without a wake-up. Meant for a dedicated core,
+// the loop keeps it busy unless a spin limit lets it block when idle.
+class BusyPollRunner
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  BusyPollRunner(boost::asio::io_context& ioc, const config::BusyPoll& conf)
+    : ioc_{ioc}, conf_{conf}, spins_{0}, events_{0}, blocks_{0}, idle_{0}
+  {
+  }
+
+  BusyPollRunner(const BusyPollRunner&) = delete;
+  BusyPollRunner& operator=(const BusyPollRunner&) = delete;
+
+  // Poll on the calling thread until the io_context stopped or ran out of
+  // work
+  void Run()
+  {
+    if (!thread::SetAffinity(conf_.cpu))
+    {
+      BOOST_LOG_SEV(client_lg, warning)
+          << "failed to pin busy poll thread to cpu " << conf_.cpu;
+    }
+
+    uint64_t empty_polls = 0;
+    Clock::time_point idle_since{};
+    while (!ioc_.stopped())
+    {
+      auto handled = ioc_.poll();
+      if (0 == handled)
+      {
+        if (Clock::time_point{} == idle_since)
+        {
+          idle_since = Clock::now();
+        }
+        Add(spins_, 1);
+        if (0 == conf_.spin_limit || ++empty_polls < conf_.spin_limit)
+        {
+          continue;
+        }
+
+        Add(blocks_, 1);
+        handled = ioc_.run_one();
+        if (0 == handled)
+        {
+          continue;
+        }
+      }
+
+      empty_polls = 0;
+      Add(events_, handled);
+      if (Clock::time_point{} != idle_since)
+      {
+        Add(idle_, (Clock::now() - idle_since).count());
+        idle_since = Clock::time_point{};
+      }
+    }
+  }
+
+  // Safe to read from any thread
+  inline PollStats Stats() const
+  {
+    PollStats stats;
+    stats.spins  = spins_.load(std::memory_order_relaxed);
+    stats.events = events_.load(std::memory_order_relaxed);
+    stats.blocks = blocks_.load(std::memory_order_relaxed);
+    stats.idle =
+        std::chrono::nanoseconds{idle_.load(std::memory_order_relaxed)};
+    return stats;
+  }
+
+ private:
+  // single writer, no need of a locked increment
+  template <class T, class V>
+  static inline void Add(std::atomic<T>& counter, V value)
+  {
+    counter.store(
+        counter.load(std::memory_order_relaxed) + static_cast<T>(value),
+        std::memory_order_relaxed);
+  }
+
+ private:
+  boost::asio::io_context& ioc_;
+  config::BusyPoll conf_;
+  std::atomic<uint64_t> spins_;
+  std::atomic<uint64_t> events_;
+  std::atomic<uint64_t> blocks_;
+  std::atomic<int64_t> idle_;
+};
+
+} // namespace phemex::common::net
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/spawn.hpp>
+
+#include "common/log.hpp"
+
+namespace phemex::common::net
+{
+// Resolved endpoints per host and port. Entries stay usable after their ttl
+// expired, so a reconnect never waits on the resolver once a host has been
+// resolved; refreshing expired entries is left to a background task.
+class EndpointCache
+{
+ public:
+  using Clock     = std::chrono::steady_clock;
+  using Endpoints = std::vector<boost::asio::ip::tcp::endpoint>;
+
+  struct Entry
+  {
+    Endpoints endpoints;
+    Clock::time_point expiry;
+  };
+
+  explicit EndpointCache(std::chrono::duration<double> ttl) : ttl_{ttl}
+  {
+  }
+
+  inline bool Enabled() const
+  {
+    return ttl_.count() > 0;
+  }
+
+  // Cached endpoints of the host, nullptr if it was never resolved
+  inline const Endpoints* Find(const std::string& host, uint16_t port) const
+  {
+    const auto it = entries_.find(Key(host, port));
+    if (entries_.end() == it)
+    {
+      return nullptr;
+    }
+    return &it->second.endpoints;
+  }
+
+  inline void Expire(const std::string& host, uint16_t port)
+  {
+    const auto it = entries_.find(Key(host, port));
+    if (entries_.end() != it)
+    {
+      it->second.expiry = Clock::time_point{};
+    }
+  }
+
+  // Resolve the host and update its entry. If the resolution fails the old
+  // endpoints are returned and ec is cleared, nullptr with ec set if there
+  // are none.
+  template <class IOContext>
+  const Endpoints* Resolve(
+      IOContext& ioc, const std::string& host, uint16_t port,
+      boost::asio::yield_context yield, boost::system::error_code& ec)
+  {
+    const auto* endpoints = Lookup(ioc, host, port, yield, ec);
+    if (endpoints)
+    {
+      return endpoints;
+    }
+
+    endpoints = Find(host, port);
+    if (endpoints)
+    {
+      BOOST_LOG_SEV(client_lg, warning)
+          << "failed to resolve " << host << ":" << port
+          << ", use cached endpoints, reason: " << ec.message();
+      ec.clear();
+    }
+    return endpoints;
+  }
+
+  // Re-resolve every expired entry
+  template <class IOContext>
+  void Refresh(IOContext& ioc, boost::asio::yield_context yield)
+  {
+    std::vector<std::pair<std::string, uint16_t>> expired;
+    const auto now = Clock::now();
+    for (const auto& [key, entry] : entries_)
+    {
+      if (entry.expiry <= now)
+      {
+        expired.push_back(key);
+      }
+    }
+
+    for (const auto& [host, port] : expired)
+    {
+      boost::system::error_code ec;
+      if (!Lookup(ioc, host, port, yield, ec))
+      {
+        BOOST_LOG_SEV(client_lg, warning)
+            << "failed to refresh endpoints of " << host << ":" << port
+            << ", keep cached ones, reason: " << ec.message();
+      }
+    }
+  }
+
+  inline const auto& Ttl() const
+  {
+    return ttl_;
+  }
+
+ private:
+  // Resolve the host into its entry, nullptr with ec set on failure
+  template <class IOContext>
+  const Endpoints* Lookup(
+      IOContext& ioc, const std::string& host, uint16_t port,
+      boost::asio::yield_context yield, boost::system::error_code& ec)
+  {
+    using boost::asio::ip::tcp;
+
+    tcp::resolver resolver(ioc);
+    const auto results = resolver.async_resolve(
+        tcp::v4(), host, std::to_string(port), yield[ec]);
+    if (!ec && results.empty())
+    {
+      ec = boost::asio::error::host_not_found;
+    }
+    if (ec)
+    {
+      return nullptr;
+    }
+
+    auto& entry = entries_[Key(host, port)];
+    entry.endpoints.assign(results.begin(), results.end());
+    entry.expiry = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                      ttl_);
+    return &entry.endpoints;
+  }
+
+  static inline std::pair<std::string, uint16_t> Key(
+      const std::string& host, uint16_t port)
+  {
+    return {host, port};
+  }
+
+ private:
+  std::chrono::duration<double> ttl_;
+  std::map<std::pair<std::string, uint16_t>, Entry> entries_;
+};
+
+} // namespace phemex::common::net
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace phemex::common::net
+{
+// Smoothed round trip times per endpoint of an address book. An endpoint is
+// ranked by its application ping rtt, by its handshake rtt until a ping was
+// measured, and is unusable after a failed attempt until it succeeds again.
+class EndpointRanking
+{
+ public:
+  struct Latency
+  {
+    // microseconds, 0 until measured
+    double handshake_rtt = 0;
+    double ping_rtt      = 0;
+    uint32_t failures    = 0;
+  };
+
+  EndpointRanking(std::size_t endpoints, double smoothing)
+    : latencies_(endpoints), smoothing_{smoothing}
+  {
+  }
+
+  template <class Rep, class Period>
+  inline void AddHandshakeRtt(
+      std::size_t index, const std::chrono::duration<Rep, Period>& rtt)
+  {
+    auto& latency = latencies_.at(index);
+    Smooth(latency.handshake_rtt, rtt);
+    latency.failures = 0;
+  }
+
+  template <class Rep, class Period>
+  inline void AddPingRtt(
+      std::size_t index, const std::chrono::duration<Rep, Period>& rtt)
+  {
+    auto& latency = latencies_.at(index);
+    Smooth(latency.ping_rtt, rtt);
+    latency.failures = 0;
+  }
+
+  inline void AddFailure(std::size_t index)
+  {
+    ++latencies_.at(index).failures;
+  }
+
+  inline double Score(std::size_t index) const
+  {
+    const auto& latency = latencies_.at(index);
+    if (latency.failures > 0)
+    {
+      return std::numeric_limits<double>::infinity();
+    }
+    if (latency.ping_rtt > 0)
+    {
+      return latency.ping_rtt;
+    }
+    if (latency.handshake_rtt > 0)
+    {
+      return latency.handshake_rtt;
+    }
+    return std::numeric_limits<double>::infinity();
+  }
+
+  // Fastest usable endpoint, fallback if none was measured
+  inline std::size_t Best(std::size_t fallback) const
+  {
+    auto best       = fallback;
+    auto best_score = std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < latencies_.size(); ++i)
+    {
+      if (Score(i) < best_score)
+      {
+        best       = i;
+        best_score = Score(i);
+      }
+    }
+    return best;
+  }
+
+  // Endpoint indexes from fastest to slowest, unmeasured ones in book order
+  inline std::vector<std::size_t> Order() const
+  {
+    std::vector<std::size_t> order(latencies_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(), order.end(),
+        [this](auto lhs, auto rhs) { return Score(lhs) < Score(rhs); });
+    return order;
+  }
+
+  // Whether another endpoint is faster than the current one by more than
+  // the hysteresis ratio
+  inline bool ShouldMigrate(
+      std::size_t current, double hysteresis, std::size_t& target) const
+  {
+    target = Best(current);
+    return target != current &&
+           Score(target) < Score(current) * (1 - hysteresis);
+  }
+
+  inline const auto& At(std::size_t index) const
+  {
+    return latencies_.at(index);
+  }
+
+  inline auto Size() const
+  {
+    return latencies_.size();
+  }
+
+ private:
+  template <class Rep, class Period>
+  inline void Smooth(
+      double& value, const std::chrono::duration<Rep, Period>& rtt)
+  {
+    const auto sample =
+        std::chrono::duration<double, std::micro>{rtt}.count();
+    value = 0 == value ? sample
+                       : smoothing_ * sample + (1 - smoothing_) * value;
+  }
+
+ private:
+  std::vector<Latency> latencies_;
+  double smoothing_;
+};
+
+} // namespace phemex::common::net
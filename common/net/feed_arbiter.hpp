@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace phemex::common::net
+{
+// Arbitrate between redundant feeds carrying the same sequenced streams: the
+// first copy of a sequence number is accepted, later copies are dropped and
+// the delay behind the winning copy is accounted to the losing feed. A
+// stream starts over when its sequence jumps back by more than the reset gap
+// or a snapshot below the last sequence arrives, as after an exchange
+// restart.
+class FeedArbiter
+{
+ public:
+  using Clock     = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  struct FeedStats
+  {
+    uint64_t wins   = 0;
+    uint64_t losses = 0;
+    // losing copies whose winner is no longer in the recent history
+    uint64_t stale       = 0;
+    // streams started over by a message of this feed
+    uint64_t resets      = 0;
+    uint64_t lag_samples = 0;
+    std::chrono::nanoseconds lag_total{0};
+    std::chrono::nanoseconds lag_max{0};
+
+    inline double WinRate() const
+    {
+      const auto total = wins + losses;
+      return 0 == total ? 0 : static_cast<double>(wins) / total;
+    }
+
+    // average delay behind the winning feed when this feed lost
+    inline std::chrono::nanoseconds MeanLag() const
+    {
+      if (0 == lag_samples)
+      {
+        return std::chrono::nanoseconds{0};
+      }
+      return lag_total / static_cast<int64_t>(lag_samples);
+    }
+  };
+
+  FeedArbiter(std::size_t feeds, int64_t reset_gap)
+    : stats_(feeds), reset_gap_{reset_gap}
+  {
+  }
+
+  // Returns true if the message is the first copy and should be delivered
+  inline bool Accept(
+      std::size_t feed, std::string_view key, int64_t sequence,
+      bool snapshot = false, const TimePoint& now = Clock::now())
+  {
+    auto it = streams_.find(key);
+    if (streams_.end() == it)
+    {
+      it = streams_.emplace(std::string{key}, Stream{}).first;
+    }
+
+    auto& stream = it->second;
+    auto& slot =
+        stream.history[static_cast<uint64_t>(sequence) % kHistorySize];
+    // a snapshot already seen is a copy of one from another feed
+    if (stream.last_sequence - sequence > reset_gap_ ||
+        (snapshot && sequence < stream.last_sequence &&
+         slot.sequence != sequence))
+    {
+      stream = Stream{};
+      ++stats_[feed].resets;
+    }
+    if (sequence > stream.last_sequence)
+    {
+      stream.last_sequence = sequence;
+      slot                 = {sequence, now};
+      ++stats_[feed].wins;
+      return true;
+    }
+
+    auto& stats = stats_[feed];
+    ++stats.losses;
+    if (slot.sequence != sequence)
+    {
+      ++stats.stale;
+      return false;
+    }
+
+    const auto lag = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        now - slot.arrival);
+    ++stats.lag_samples;
+    stats.lag_total += lag;
+    if (lag > stats.lag_max)
+    {
+      stats.lag_max = lag;
+    }
+    return false;
+  }
+
+  inline const auto& Stats(std::size_t feed) const
+  {
+    return stats_.at(feed);
+  }
+
+  inline auto Feeds() const
+  {
+    return stats_.size();
+  }
+
+  // Forget the stream, its next message is accepted whatever its sequence
+  inline void Reset(std::string_view key)
+  {
+    const auto it = streams_.find(key);
+    if (streams_.end() != it)
+    {
+      streams_.erase(it);
+    }
+  }
+
+  inline void ResetStats()
+  {
+    for (auto& stats : stats_)
+    {
+      stats = FeedStats{};
+    }
+  }
+
+ private:
+  static constexpr std::size_t kHistorySize = 64;
+
+  struct Arrival
+  {
+    int64_t sequence = -1;
+    TimePoint arrival;
+  };
+
+  struct Stream
+  {
+    int64_t last_sequence = -1;
+    std::array<Arrival, kHistorySize> history;
+  };
+
+  std::vector<FeedStats> stats_;
+  int64_t reset_gap_;
+  std::map<std::string, Stream, std::less<>> streams_;
+};
+
+} // namespace phemex::common::net
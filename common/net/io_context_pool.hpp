@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include "common/config/io_context_pool.hpp"
+#include "common/net/busy_poll_runner.hpp"
+#include "common/log.hpp"
+#include "common/thread/affinity.hpp"
+
+namespace phemex::common::net
+{
+// One io_context per thread. A connection created on the io_context returned
+// by Next() keeps all of its work (tls, decoding, callbacks) on that thread.
+class IOContextPool
+{
+ public:
+  using WorkGuard =
+      boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+  explicit IOContextPool(const config::IOContextPool& conf)
+    : conf_{conf}, next_{0}
+  {
+    if (0 == conf_.threads)
+    {
+      throw std::invalid_argument{"io context pool should have a thread"};
+    }
+
+    for (uint32_t i = 0; i < conf_.threads; ++i)
+    {
+      // one thread per io_context, no need of internal locking
+      contexts_.push_back(std::make_unique<boost::asio::io_context>(1));
+      guards_.push_back(
+          boost::asio::make_work_guard(contexts_.back()->get_executor()));
+
+      config::BusyPoll busy_poll;
+      busy_poll.cpu        = i < conf_.cpus.size() ? conf_.cpus[i] : -1;
+      busy_poll.spin_limit = conf_.spin_limit;
+      runners_.push_back(
+          std::make_unique<BusyPollRunner>(*contexts_.back(), busy_poll));
+    }
+  }
+
+  IOContextPool(const IOContextPool&) = delete;
+  IOContextPool& operator=(const IOContextPool&) = delete;
+
+  ~IOContextPool()
+  {
+    Stop();
+    Join();
+  }
+
+  // Start one thread per io_context
+  void Run()
+  {
+    for (std::size_t i = 0; i < contexts_.size(); ++i)
+    {
+      threads_.emplace_back([this, i]() {
+        // the runner pins its thread on its own
+        if (conf_.busy_poll)
+        {
+          runners_[i]->Run();
+          return;
+        }
+
+        const auto cpu = i < conf_.cpus.size() ? conf_.cpus[i] : -1;
+        if (!thread::SetAffinity(cpu))
+        {
+          BOOST_LOG_SEV(client_lg, warning)
+              << "failed to pin io thread " << i << " to cpu " << cpu;
+        }
+        contexts_[i]->run();
+      });
+    }
+  }
+
+  inline void Stop()
+  {
+    guards_.clear();
+    for (auto& context : contexts_)
+    {
+      context->stop();
+    }
+  }
+
+  inline void Join()
+  {
+    for (auto& thread : threads_)
+    {
+      if (thread.joinable())
+      {
+        thread.join();
+      }
+    }
+    threads_.clear();
+  }
+
+  // Assign io_contexts to new connections round-robin
+  inline boost::asio::io_context& Next()
+  {
+    return *contexts_[next_.fetch_add(1) % contexts_.size()];
+  }
+
+  inline boost::asio::io_context& At(std::size_t index)
+  {
+    return *contexts_.at(index);
+  }
+
+  inline auto Size() const
+  {
+    return contexts_.size();
+  }
+
+  // Poll counters of thread i, all zero unless busy polling
+  inline auto Stats(std::size_t index) const
+  {
+    return runners_.at(index)->Stats();
+  }
+
+ private:
+  config::IOContextPool conf_;
+  std::vector<std::unique_ptr<boost::asio::io_context>> contexts_;
+  std::vector<WorkGuard> guards_;
+  std::vector<std::unique_ptr<BusyPollRunner>> runners_;
+  std::vector<std::thread> threads_;
+  std::atomic<std::size_t> next_;
+};
+
+} // namespace phemex::common::net
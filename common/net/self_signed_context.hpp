@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <boost/asio/ssl.hpp>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+namespace phemex::common::net
+{
+// Server side tls context with a throwaway P-256 key and certificate made at
+// startup, for local servers talking to clients that skip verification
+inline boost::asio::ssl::context MakeSelfSignedContext(
+    const std::string& common_name = "localhost")
+{
+  using PKey     = std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)>;
+  using PKeyCtx  = std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)>;
+  using X509Cert = std::unique_ptr<X509, decltype(&X509_free)>;
+
+  PKeyCtx key_ctx{EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr),
+                  &EVP_PKEY_CTX_free};
+  EVP_PKEY* raw_key = nullptr;
+  if (!key_ctx || EVP_PKEY_keygen_init(key_ctx.get()) <= 0 ||
+      EVP_PKEY_CTX_set_ec_paramgen_curve_nid(
+          key_ctx.get(), NID_X9_62_prime256v1) <= 0 ||
+      EVP_PKEY_keygen(key_ctx.get(), &raw_key) <= 0)
+  {
+    throw std::runtime_error{"failed to generate private key"};
+  }
+  PKey key{raw_key, &EVP_PKEY_free};
+
+  X509Cert cert{X509_new(), &X509_free};
+  if (!cert)
+  {
+    throw std::runtime_error{"failed to allocate certificate"};
+  }
+  X509_set_version(cert.get(), 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+  X509_gmtime_adj(X509_getm_notBefore(cert.get()), 0);
+  X509_gmtime_adj(X509_getm_notAfter(cert.get()), 365L * 24 * 3600);
+  X509_set_pubkey(cert.get(), key.get());
+
+  auto* name = X509_get_subject_name(cert.get());
+  X509_NAME_add_entry_by_txt(
+      name, "CN", MBSTRING_ASC,
+      reinterpret_cast<const unsigned char*>(common_name.c_str()), -1, -1, 0);
+  X509_set_issuer_name(cert.get(), name);
+  if (0 == X509_sign(cert.get(), key.get(), EVP_sha256()))
+  {
+    throw std::runtime_error{"failed to sign certificate"};
+  }
+
+  boost::asio::ssl::context context{boost::asio::ssl::context::tls_server};
+  if (1 != SSL_CTX_use_certificate(context.native_handle(), cert.get()) ||
+      1 != SSL_CTX_use_PrivateKey(context.native_handle(), key.get()))
+  {
+    throw std::runtime_error{"failed to install self signed certificate"};
+  }
+  return context;
+}
+
+} // namespace phemex::common::net
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <string>
+
+namespace phemex::common::net
+{
+// Policies used to pick a shard for a new symbol. The shards container holds
+// pointers to objects exposing `Symbols()` and `MessageRate()`.
+class HashShardPolicy
+{
+ public:
+  template <class Shards>
+  inline std::size_t Select(const std::string& symbol, const Shards& shards)
+  {
+    return std::hash<std::string>{}(symbol) % shards.size();
+  }
+};
+
+class RoundRobinShardPolicy
+{
+ public:
+  template <class Shards>
+  inline std::size_t Select(const std::string&, const Shards& shards)
+  {
+    return next_++ % shards.size();
+  }
+
+ private:
+  std::size_t next_ = 0;
+};
+
+class LoadWeightedShardPolicy
+{
+ public:
+  // Pick the shard with the lowest observed message rate, the one holding
+  // fewer symbols wins a tie (e.g. before any data arrived)
+  template <class Shards>
+  inline std::size_t Select(const std::string&, const Shards& shards)
+  {
+    std::size_t index = 0;
+    auto min_rate     = std::numeric_limits<double>::max();
+    auto min_symbols  = std::numeric_limits<std::size_t>::max();
+    for (std::size_t i = 0; i < shards.size(); ++i)
+    {
+      const auto rate    = shards[i]->MessageRate();
+      const auto symbols = shards[i]->Symbols();
+      if (rate < min_rate || (rate == min_rate && symbols < min_symbols))
+      {
+        index       = i;
+        min_rate    = rate;
+        min_symbols = symbols;
+      }
+    }
+    return index;
+  }
+};
+
+} // namespace phemex::common::net
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include <boost/asio/ip/tcp.hpp>
+
+#include "common/config/socket_options.hpp"
+#include "common/config/utils.hpp"
+#include "common/log.hpp"
+
+namespace phemex::common::net
+{
+namespace option
+{
+template <int Level, int Name>
+using Boolean = boost::asio::detail::socket_option::boolean<Level, Name>;
+
+template <int Level, int Name>
+using Integer = boost::asio::detail::socket_option::integer<Level, Name>;
+
+#ifdef TCP_QUICKACK
+using QuickAck = Boolean<IPPROTO_TCP, TCP_QUICKACK>;
+#endif
+#ifdef SO_BUSY_POLL
+using BusyPoll = Integer<SOL_SOCKET, SO_BUSY_POLL>;
+#endif
+#ifdef SO_PRIORITY
+using Priority = Integer<SOL_SOCKET, SO_PRIORITY>;
+#endif
+using TypeOfService = Integer<IPPROTO_IP, IP_TOS>;
+} // namespace option
+
+// Socket option values as granted by the kernel
+struct SocketReport
+{
+  bool no_delay          = false;
+  int32_t receive_buffer = 0;
+  int32_t send_buffer    = 0;
+  bool quick_ack         = false;
+  int32_t busy_poll      = 0;
+  int32_t tos            = 0;
+  int32_t priority       = 0;
+
+  inline auto ToString(int32_t indent_chars = 0) const
+  {
+    using namespace config;
+    std::ostringstream oss;
+    PutHeader(oss, indent_chars, "socket");
+    PutLine(oss, indent_chars + 2, "no_delay", no_delay);
+    PutLine(oss, indent_chars + 2, "receive_buffer", receive_buffer);
+    PutLine(oss, indent_chars + 2, "send_buffer", send_buffer);
+    PutLine(oss, indent_chars + 2, "quick_ack", quick_ack);
+    PutLine(oss, indent_chars + 2, "busy_poll", busy_poll);
+    PutLine(oss, indent_chars + 2, "tos", tos);
+    PutLine(oss, indent_chars + 2, "priority", priority);
+    return oss.str();
+  }
+};
+
+namespace impl
+{
+template <class Socket, class Option>
+inline void SetOption(
+    Socket& socket, const Option& option, std::string_view name)
+{
+  boost::system::error_code ec;
+  socket.set_option(option, ec);
+  if (ec)
+  {
+    BOOST_LOG_SEV(client_lg, warning)
+        << "failed to set socket option " << name
+        << ", reason: " << ec.message();
+  }
+}
+
+template <class Option, class Socket>
+inline auto GetOption(Socket& socket)
+{
+  boost::system::error_code ec;
+  Option option;
+  socket.get_option(option, ec);
+  return option.value();
+}
+} // namespace impl
+
+template <class Socket>
+inline void ApplySocketOptions(
+    Socket& socket, const config::SocketOptions& conf)
+{
+  using boost::asio::socket_base;
+
+  if (conf.no_delay)
+  {
+    impl::SetOption(
+        socket, boost::asio::ip::tcp::no_delay{true}, "TCP_NODELAY");
+  }
+  if (conf.receive_buffer > 0)
+  {
+    impl::SetOption(
+        socket, socket_base::receive_buffer_size{conf.receive_buffer},
+        "SO_RCVBUF");
+  }
+  if (conf.send_buffer > 0)
+  {
+    impl::SetOption(
+        socket, socket_base::send_buffer_size{conf.send_buffer}, "SO_SNDBUF");
+  }
+#ifdef TCP_QUICKACK
+  if (conf.quick_ack)
+  {
+    impl::SetOption(socket, option::QuickAck{true}, "TCP_QUICKACK");
+  }
+#endif
+#ifdef SO_BUSY_POLL
+  if (conf.busy_poll > 0)
+  {
+    impl::SetOption(socket, option::BusyPoll{conf.busy_poll}, "SO_BUSY_POLL");
+  }
+#endif
+  if (conf.tos >= 0)
+  {
+    impl::SetOption(socket, option::TypeOfService{conf.tos}, "IP_TOS");
+  }
+#ifdef SO_PRIORITY
+  if (conf.priority >= 0)
+  {
+    impl::SetOption(socket, option::Priority{conf.priority}, "SO_PRIORITY");
+  }
+#endif
+}
+
+template <class Socket>
+inline auto GetSocketReport(Socket& socket)
+{
+  using boost::asio::socket_base;
+
+  SocketReport report;
+  report.no_delay = impl::GetOption<boost::asio::ip::tcp::no_delay>(socket);
+  report.receive_buffer =
+      impl::GetOption<socket_base::receive_buffer_size>(socket);
+  report.send_buffer = impl::GetOption<socket_base::send_buffer_size>(socket);
+#ifdef TCP_QUICKACK
+  report.quick_ack = impl::GetOption<option::QuickAck>(socket);
+#endif
+#ifdef SO_BUSY_POLL
+  report.busy_poll = impl::GetOption<option::BusyPoll>(socket);
+#endif
+  report.tos = impl::GetOption<option::TypeOfService>(socket);
+#ifdef SO_PRIORITY
+  report.priority = impl::GetOption<option::Priority>(socket);
+#endif
+  return report;
+}
+
+// Keep quick ack on, the kernel falls back to delayed ack on its own
+template <class Socket>
+inline void RearmQuickAck(Socket& socket)
+{
+#ifdef TCP_QUICKACK
+  boost::system::error_code ec;
+  socket.set_option(option::QuickAck{true}, ec);
+#endif
+}
+
+} // namespace phemex::common::net
@@ -1,11 +1,53 @@
 #pragma once
 
+#include <chrono>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
 
 #include <boost/asio/ssl.hpp>
 
 namespace phemex::common::net
 {
+// Time spent in tls handshakes, split into full and resumed ones
+struct HandshakeStats
+{
+  uint64_t full    = 0;
+  uint64_t resumed = 0;
+  std::chrono::nanoseconds full_total{0};
+  std::chrono::nanoseconds resumed_total{0};
+
+  inline void Add(std::chrono::nanoseconds duration, bool reused)
+  {
+    if (reused)
+    {
+      ++resumed;
+      resumed_total += duration;
+    }
+    else
+    {
+      ++full;
+      full_total += duration;
+    }
+  }
+
+  inline auto MeanFull() const
+  {
+    return 0 == full ? std::chrono::nanoseconds{0}
+                     : full_total / static_cast<int64_t>(full);
+  }
+
+  inline auto MeanResumed() const
+  {
+    return 0 == resumed ? std::chrono::nanoseconds{0}
+                        : resumed_total / static_cast<int64_t>(resumed);
+  }
+};
+
+// SSL context with a client side session cache keyed by remote endpoint, so
+// reconnects resume their tls session. One context can be shared by many
+// connections on different threads.
 class SSLContext
 {
  public:
@@ -16,12 +58,32 @@ class SSLContext
     LoadRootCertificates(context_, ec);
     if (ec)
       throw std::runtime_error{"failed to load root certificate"};
+    EnableSessionCache();
+  }
+
+  SSLContext(const SSLContext&) = delete;
+  SSLContext& operator=(const SSLContext&) = delete;
+
+  ~SSLContext()
+  {
+    for (auto& [key, session] : sessions_)
+    {
+      SSL_SESSION_free(session);
+    }
+  }
+
+  // Process wide client context
+  static inline const std::shared_ptr<SSLContext>& Shared()
+  {
+    static const auto context = std::make_shared<SSLContext>(
+        boost::asio::ssl::context::sslv23_client);
+    return context;
   }
 
   void LoadRootCertificates(
       boost::asio::ssl::context& ctx, boost::system::error_code& ec)
   {
-    constexpr const auto cert =
+    static constexpr const char cert[] =
         /*  This is the DigiCert root certificate.
 
             CN = DigiCert High Assurance EV Root CA
@@ -91,7 +153,7 @@ class SSLContext
     ctx.set_verify_mode(boost::asio::ssl::verify_none);
     ctx.set_options(boost::asio::ssl::context::default_workarounds);
     ctx.add_certificate_authority(
-        boost::asio::const_buffer(cert, sizeof(cert)), ec);
+        boost::asio::const_buffer(cert, sizeof(cert) - 1), ec);
   }
 
   inline auto& Context()
@@ -99,8 +161,77 @@ class SSLContext
     return context_;
   }
 
+  // Offer the cached session of the key on the next handshake, the key has
+  // to outlive the ssl object
+  inline void PrepareSession(SSL* ssl, const std::string* key)
+  {
+    SSL_set_ex_data(ssl, KeyIndex(), const_cast<std::string*>(key));
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    const auto it = sessions_.find(*key);
+    if (sessions_.end() != it)
+    {
+      SSL_set_session(ssl, it->second);
+    }
+  }
+
+  inline auto Sessions() const
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return sessions_.size();
+  }
+
+ private:
+  inline void EnableSessionCache()
+  {
+    auto* handle = context_.native_handle();
+    SSL_CTX_set_ex_data(handle, ContextIndex(), this);
+    SSL_CTX_set_session_cache_mode(
+        handle, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(handle, &SSLContext::OnNewSession);
+  }
+
+  // Called by openssl once the server issued a session (ticket)
+  static int OnNewSession(SSL* ssl, SSL_SESSION* session)
+  {
+    auto* self = static_cast<SSLContext*>(
+        SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), ContextIndex()));
+    const auto* key =
+        static_cast<std::string*>(SSL_get_ex_data(ssl, KeyIndex()));
+    if (!self || !key)
+    {
+      return 0;
+    }
+
+    std::lock_guard<std::mutex> lock{self->mutex_};
+    auto& cached = self->sessions_[*key];
+    if (cached)
+    {
+      SSL_SESSION_free(cached);
+    }
+    // keep the reference handed over by openssl
+    cached = session;
+    return 1;
+  }
+
+  static inline int ContextIndex()
+  {
+    static const int index =
+        SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+  }
+
+  static inline int KeyIndex()
+  {
+    static const int index =
+        SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+  }
+
  private:
   boost::asio::ssl::context context_;
+  mutable std::mutex mutex_;
+  std::map<std::string, SSL_SESSION*> sessions_;
 };
 
 } // namespace phemex::common::net
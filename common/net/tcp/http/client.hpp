@@ -0,0 +1,476 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "common/config/rest_client.hpp"
+#include "common/log.hpp"
+#include "common/net/address_book.hpp"
+#include "common/net/endpoint_cache.hpp"
+#include "common/net/ssl_context.hpp"
+#include "common/net/tcp/http/connection.hpp"
+#include "common/net/utils.hpp"
+
+namespace phemex::common::net::tcp::http
+{
+// Response of a request, with the time from the start of its write to the
+// end of the response read
+struct Result
+{
+  boost::system::error_code ec;
+  Response response;
+  std::chrono::nanoseconds rtt{0};
+};
+
+// Pool of keep-alive https connections to the address book. Requests queue on
+// the strand and the first idle connection takes the next one, connections
+// are opened at start and an idle one sends a keep-alive request now and
+// then so the server does not drop it. A request still queued after
+// request_timeout, e.g. while no connection is open, fails with timed_out
+// rather than going out late. Handlers run on the strand.
+class Client : public AddressBook
+{
+ public:
+  using Handler = std::function<void(Result&&)>;
+
+  Client(
+      boost::asio::io_context& ioc, const config::RestClient& conf,
+      bool start = true,
+      std::shared_ptr<SSLContext> ssl_context = SSLContext::Shared())
+    : AddressBook{MakeAddressBook(conf)},
+      ssl_context_{std::move(ssl_context)},
+      strand_{ioc},
+      conf_{conf},
+      timeout_{ToTimer(std::chrono::duration<double>{conf.request_timeout})},
+      endpoint_cache_{std::chrono::duration<double>{conf.dns_ttl}},
+      expiry_{ioc}
+  {
+    if (!AddressBook::UseSSL())
+    {
+      throw std::invalid_argument{"rest client supports https only, url: " +
+                                  AddressBook::Url()};
+    }
+    if (0 == conf_.connections)
+    {
+      throw std::invalid_argument{"rest client needs a connection"};
+    }
+    for (uint32_t i = 0; i < conf_.connections; ++i)
+    {
+      workers_.push_back(std::make_unique<Worker>(ioc, *ssl_context_));
+    }
+    if (start)
+    {
+      Start();
+    }
+  }
+
+  Client(const Client&) = delete;
+  Client& operator=(const Client&) = delete;
+
+  // Connect every connection, warming the tls session cache
+  void Start()
+  {
+    for (auto& worker : workers_)
+    {
+      boost::asio::spawn(
+          strand_,
+          [this, worker = worker.get()](boost::asio::yield_context yield) {
+            Run(*worker, yield);
+          });
+    }
+  }
+
+  inline void Stop()
+  {
+    BOOST_LOG(client_lg) << "stop rest client connections to " << Url();
+    boost::asio::post(strand_, [this]() {
+      closed_ = true;
+      expiry_.cancel();
+      for (auto& worker : workers_)
+      {
+        worker->wake.cancel();
+        worker->deadline.cancel();
+        worker->connection.Close();
+      }
+      for (auto& pending : queue_)
+      {
+        pending.handler(
+            {boost::asio::error::operation_aborted, Response{}, {}});
+      }
+      queue_.clear();
+    });
+  }
+
+  // Queue the request, its host is set here, at once when called on the
+  // strand. The handler gets operation_aborted once stopped,
+  // no_buffer_space if the queue is full and timed_out if no connection
+  // took it within request_timeout.
+  void Send(Request&& request, Handler handler)
+  {
+    auto send = [this, request = std::move(request),
+                 handler = std::move(handler)]() mutable {
+      request.set(boost::beast::http::field::host, AddressBook::Host());
+      Queue({std::move(request), std::string{}, std::move(handler), {}});
+    };
+    boost::asio::dispatch(strand_, std::move(send));
+  }
+
+  // Queue a request serialized by the caller, its Host header is pointed at
+  // the current address here as it may have been serialized before a
+  // failover
+  void Send(std::string&& request, Handler handler)
+  {
+    auto send = [this, request = std::move(request),
+                 handler = std::move(handler)]() mutable {
+      SetHost(request);
+      Queue({Request{}, std::move(request), std::move(handler), {}});
+    };
+    boost::asio::dispatch(strand_, std::move(send));
+  }
+
+  // Connections open now, read on the thread of the client
+  inline std::size_t Connected() const
+  {
+    std::size_t connected = 0;
+    for (const auto& worker : workers_)
+    {
+      connected += worker->connection.IsOpen() ? 1 : 0;
+    }
+    return connected;
+  }
+
+  inline auto& Strand()
+  {
+    return strand_;
+  }
+
+ private:
+  struct Pending
+  {
+    Request request;
+    // serialized request, sent instead of request if not empty
+    std::string wire;
+    Handler handler;
+    // set by Queue()
+    std::chrono::steady_clock::time_point queued;
+
+    inline std::string_view Target() const
+    {
+      return wire.empty()
+                 ? std::string_view{request.target().data(),
+                                    request.target().size()}
+                 : std::string_view{wire}.substr(0, wire.find('\r'));
+    }
+  };
+
+  // One connection and the coroutine serving it
+  struct Worker
+  {
+    Worker(boost::asio::io_context& ioc, SSLContext& context)
+      : connection{ioc, context}, wake{ioc}, deadline{ioc}
+    {
+    }
+
+    Connection connection;
+    // cancelled when a request is queued for an idle worker
+    boost::asio::steady_timer wake;
+    boost::asio::steady_timer deadline;
+    // tells a deadline handler already queued when its exchange ended from
+    // the one of the next exchange
+    uint64_t exchange = 0;
+    bool idle         = false;
+    bool sending      = false;
+    bool timed_out    = false;
+  };
+
+  static inline std::vector<config::HostAddress> MakeAddressBook(
+      const config::RestClient& conf)
+  {
+    std::vector<config::HostAddress> book{conf.addr};
+    book.insert(
+        book.end(), conf.fallback_addrs.begin(), conf.fallback_addrs.end());
+    return book;
+  }
+
+  template <class Duration>
+  static inline boost::asio::steady_timer::duration ToTimer(Duration duration)
+  {
+    return std::chrono::duration_cast<boost::asio::steady_timer::duration>(
+        duration);
+  }
+
+  // Replace the Host header value if it is not the current host, requests
+  // without one are left alone
+  inline void SetHost(std::string& request) const
+  {
+    static constexpr std::string_view kField{"\r\nHost: "};
+    const auto& host = AddressBook::Host();
+    const auto field = request.find(kField);
+    if (std::string::npos == field || field > request.find("\r\n\r\n"))
+    {
+      return;
+    }
+    const auto begin = field + kField.size();
+    const auto end   = request.find("\r\n", begin);
+    if (0 != request.compare(begin, end - begin, host))
+    {
+      request.replace(begin, end - begin, host);
+    }
+  }
+
+  inline void Queue(Pending&& pending)
+  {
+    if (closed_)
+    {
+      pending.handler({boost::asio::error::operation_aborted, Response{}, {}});
+      return;
+    }
+    if (queue_.size() >= conf_.queue_size)
+    {
+      BOOST_LOG_SEV(client_lg, error)
+          << "rest request queue is full, reject " << pending.Target();
+      pending.handler({boost::asio::error::no_buffer_space, Response{}, {}});
+      return;
+    }
+    pending.queued = std::chrono::steady_clock::now();
+    queue_.push_back(std::move(pending));
+    ArmExpiry();
+    Wake();
+  }
+
+  // Fail the requests queued for longer than request_timeout, the queue is
+  // in the order they came in
+  inline void Expire()
+  {
+    const auto now = std::chrono::steady_clock::now();
+    while (!queue_.empty() && queue_.front().queued + timeout_ <= now)
+    {
+      auto pending = std::move(queue_.front());
+      queue_.pop_front();
+      BOOST_LOG_SEV(client_lg, error)
+          << "rest request waited " << conf_.request_timeout
+          << "s for a connection, fail " << pending.Target();
+      pending.handler({boost::asio::error::timed_out, Response{}, {}});
+    }
+    ArmExpiry();
+  }
+
+  inline void ArmExpiry()
+  {
+    if (expiring_ || closed_ || queue_.empty())
+    {
+      return;
+    }
+    expiring_ = true;
+    expiry_.expires_at(queue_.front().queued + timeout_);
+    expiry_.async_wait(boost::asio::bind_executor(
+        strand_, [this](const boost::system::error_code& ec) {
+          expiring_ = false;
+          if (!ec)
+          {
+            Expire();
+          }
+        }));
+  }
+
+  inline void Wake()
+  {
+    for (auto& worker : workers_)
+    {
+      if (worker->idle)
+      {
+        worker->idle = false;
+        worker->wake.cancel();
+        return;
+      }
+    }
+  }
+
+  void Run(Worker& worker, boost::asio::yield_context yield)
+  {
+    const auto keep_alive = ToTimer(
+        std::chrono::duration<double>{conf_.keep_alive_interval});
+    auto& connection = worker.connection;
+    while (!closed_)
+    {
+      if (!connection.IsOpen() && !Connect(connection, yield))
+      {
+        AsyncWait(
+            strand_, yield,
+            std::chrono::duration<double>{conf_.reconnect_interval});
+        continue;
+      }
+
+      if (queue_.empty())
+      {
+        const auto idle_until =
+            keep_alive.count() > 0
+                ? connection.LastUsed() + keep_alive
+                : boost::asio::steady_timer::time_point::max();
+        if (std::chrono::steady_clock::now() < idle_until)
+        {
+          boost::system::error_code ec;
+          worker.idle = true;
+          worker.wake.expires_at(idle_until);
+          worker.wake.async_wait(yield[ec]);
+          worker.idle = false;
+          continue;
+        }
+        KeepAlive(worker, yield);
+        continue;
+      }
+
+      auto pending = std::move(queue_.front());
+      queue_.pop_front();
+      if (pending.queued + timeout_ <= std::chrono::steady_clock::now())
+      {
+        pending.handler({boost::asio::error::timed_out, Response{}, {}});
+        continue;
+      }
+      auto result = Exchange(worker, pending, yield);
+      pending.handler(std::move(result));
+    }
+  }
+
+  bool Connect(Connection& connection, boost::asio::yield_context yield)
+  {
+    const auto& addr = AddressBook::Current();
+    boost::system::error_code ec;
+    const auto* endpoints = endpoint_cache_.Enabled()
+                                ? endpoint_cache_.Find(addr.host, addr.port)
+                                : nullptr;
+    if (!endpoints)
+    {
+      endpoints = endpoint_cache_.Resolve(
+          strand_.context(), addr.host, addr.port, yield, ec);
+    }
+    if (!endpoints)
+    {
+      Fail(ec, "resolve", addr.url);
+      AddressBook::UseNext();
+      return false;
+    }
+
+    connection.Connect(
+        addr, *endpoints, conf_.socket, conf_.enable_sni, yield, ec);
+    if (ec)
+    {
+      Fail(ec, "connect", addr.url);
+      connection.Close();
+      endpoint_cache_.Expire(addr.host, addr.port);
+      AddressBook::UseNext();
+      return false;
+    }
+    BOOST_LOG(client_lg) << "rest connection to " << addr.url
+                         << " open, tls resumed: "
+                         << connection.SessionReused();
+    return true;
+  }
+
+  // Send the request on the connection of the worker, which is closed on a
+  // failure, a timeout or if the server does not keep it alive
+  Result Exchange(
+      Worker& worker, const Pending& pending, boost::asio::yield_context yield)
+  {
+    auto& connection = worker.connection;
+    Result result;
+    if (!connection.IsOpen())
+    {
+      result.ec = boost::asio::error::not_connected;
+      return result;
+    }
+
+    const auto exchange = ++worker.exchange;
+    worker.deadline.expires_after(timeout_);
+    worker.deadline.async_wait(boost::asio::bind_executor(
+        strand_, [&worker, exchange](const boost::system::error_code& ec) {
+          if (!ec && worker.sending && exchange == worker.exchange)
+          {
+            worker.timed_out = true;
+            worker.connection.Close();
+          }
+        }));
+
+    const auto start = std::chrono::steady_clock::now();
+    worker.sending   = true;
+    worker.timed_out = false;
+    if (pending.wire.empty())
+    {
+      connection.Send(pending.request, result.response, yield, result.ec);
+    }
+    else
+    {
+      connection.Send(pending.wire, result.response, yield, result.ec);
+    }
+    worker.sending = false;
+    result.rtt     = std::chrono::steady_clock::now() - start;
+    worker.deadline.cancel();
+
+    if (worker.timed_out)
+    {
+      result.ec = boost::asio::error::timed_out;
+    }
+    if (result.ec)
+    {
+      Fail(result.ec, "send " + std::string{pending.Target()});
+      connection.Close();
+    }
+    else if (!result.response.keep_alive())
+    {
+      connection.Close();
+    }
+    return result;
+  }
+
+  void KeepAlive(Worker& worker, boost::asio::yield_context yield)
+  {
+    Pending pending{
+        {boost::beast::http::verb::get, conf_.keep_alive_path, 11}};
+    pending.request.set(boost::beast::http::field::host, AddressBook::Host());
+    pending.request.keep_alive(true);
+    const auto result = Exchange(worker, pending, yield);
+    BOOST_LOG_SEV(client_lg, debug)
+        << "rest keep-alive to " << Url() << ", status "
+        << result.response.result_int() << ", rtt "
+        << std::chrono::duration_cast<std::chrono::microseconds>(result.rtt)
+               .count()
+        << "us";
+  }
+
+  inline void Fail(const boost::system::error_code& ec, std::string_view what)
+  {
+    Fail(ec, what, Url());
+  }
+
+  inline void Fail(
+      const boost::system::error_code& ec, std::string_view what,
+      std::string_view url)
+  {
+    BOOST_LOG_SEV(client_lg, error) << "failed to " << what << " " << url
+                                    << ", error msg=" << ec.message();
+  }
+
+ private:
+  std::shared_ptr<SSLContext> ssl_context_;
+  boost::asio::io_context::strand strand_;
+  config::RestClient conf_;
+  boost::asio::steady_timer::duration timeout_;
+  EndpointCache endpoint_cache_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::deque<Pending> queue_;
+  // fires when the oldest queued request times out
+  boost::asio::steady_timer expiry_;
+  bool expiring_ = false;
+  bool closed_   = false;
+};
+
+} // namespace phemex::common::net::tcp::http
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http.hpp>
+
+#include "common/config/socket_options.hpp"
+#include "common/log.hpp"
+#include "common/net/endpoint_cache.hpp"
+#include "common/net/socket_options.hpp"
+#include "common/net/ssl_context.hpp"
+
+namespace phemex::common::net::tcp::http
+{
+using Request  = boost::beast::http::request<boost::beast::http::string_body>;
+using Response = boost::beast::http::response<boost::beast::http::string_body>;
+
+// One keep-alive https connection, requests on it run one after another.
+// The tls stream is built anew on every connect, a closed one can not be
+// used for another session.
+class Connection
+{
+ public:
+  using Stream = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
+
+  Connection(boost::asio::io_context& ioc, SSLContext& context)
+    : ioc_{ioc}, context_{context}
+  {
+  }
+
+  Connection(const Connection&) = delete;
+  Connection& operator=(const Connection&) = delete;
+
+  ~Connection()
+  {
+    Close();
+  }
+
+  inline bool IsOpen() const
+  {
+    return stream_ && stream_->lowest_layer().is_open();
+  }
+
+  // Run the tcp and tls handshakes, the tls session of the url is resumed
+  // if cached
+  void Connect(
+      const config::HostAddress& addr,
+      const EndpointCache::Endpoints& endpoints,
+      const config::SocketOptions& options, bool sni,
+      boost::asio::yield_context yield, boost::system::error_code& ec)
+  {
+    Close();
+    stream_ = std::make_unique<Stream>(ioc_, context_.Context());
+    if (sni &&
+        !SSL_set_tlsext_host_name(stream_->native_handle(), addr.host.c_str()))
+    {
+      ec = boost::system::error_code{static_cast<int>(::ERR_get_error()),
+                                     boost::asio::error::get_ssl_category()};
+      return;
+    }
+
+    boost::asio::async_connect(stream_->lowest_layer(), endpoints, yield[ec]);
+    if (ec)
+    {
+      return;
+    }
+    ApplySocketOptions(stream_->lowest_layer(), options);
+
+    session_key_ = addr.url;
+    context_.PrepareSession(stream_->native_handle(), &session_key_);
+    stream_->async_handshake(boost::asio::ssl::stream_base::client, yield[ec]);
+    if (!ec)
+    {
+      last_used_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  // Write the request and read its response
+  void Send(
+      const Request& request, Response& response,
+      boost::asio::yield_context yield, boost::system::error_code& ec)
+  {
+    boost::beast::http::async_write(*stream_, request, yield[ec]);
+    if (ec)
+    {
+      return;
+    }
+    boost::beast::http::async_read(*stream_, buffer_, response, yield[ec]);
+    last_used_ = std::chrono::steady_clock::now();
+  }
+
+  // Write a request serialized by the caller and read its response
+  void Send(
+      std::string_view request, Response& response,
+      boost::asio::yield_context yield, boost::system::error_code& ec)
+  {
+    boost::asio::async_write(
+        *stream_, boost::asio::buffer(request.data(), request.size()),
+        yield[ec]);
+    if (ec)
+    {
+      return;
+    }
+    boost::beast::http::async_read(*stream_, buffer_, response, yield[ec]);
+    last_used_ = std::chrono::steady_clock::now();
+  }
+
+  inline bool SessionReused() const
+  {
+    return stream_ && 1 == SSL_session_reused(stream_->native_handle());
+  }
+
+  // Time of the last response or handshake
+  inline const auto& LastUsed() const
+  {
+    return last_used_;
+  }
+
+  // Drop the connection without a tls close_notify, the session stays
+  // resumable
+  inline void Close()
+  {
+    if (!IsOpen())
+    {
+      return;
+    }
+
+    auto* ssl = stream_->native_handle();
+    if (SSL_is_init_finished(ssl))
+    {
+      SSL_set_shutdown(ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    }
+
+    boost::system::error_code ec;
+    auto& socket = stream_->lowest_layer();
+    socket.cancel(ec);
+    socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+    socket.close(ec);
+    buffer_.consume(buffer_.size());
+  }
+
+ private:
+  boost::asio::io_context& ioc_;
+  SSLContext& context_;
+  std::unique_ptr<Stream> stream_;
+  boost::beast::flat_buffer buffer_;
+  std::string session_key_;
+  std::chrono::steady_clock::time_point last_used_;
+};
+
+} // namespace phemex::common::net::tcp::http
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/config/rest_client.hpp"
+#include "common/net/tcp/http/connection.hpp"
+
+namespace phemex::common::net::tcp::http
+{
+// Request budget of one rate limit group
+struct RateBudget
+{
+  // local estimate, negative once high priority requests overdraw it
+  double tokens     = 0;
+  uint32_t capacity = 0;
+  uint32_t reserve  = 0;
+  // seconds until the server lifts its block, 0 if not blocked
+  double blocked_for = 0;
+};
+
+// Token buckets of the rate limit groups of a rest api. A bucket refills at
+// capacity per period and follows the x-ratelimit-remaining-<group>,
+// x-ratelimit-capacity-<group> and x-ratelimit-retry-after-<group> headers
+// of the responses, so usage by other clients of the key is seen too. Low
+// priority requests only take the tokens above the reserve, high priority
+// ones may overdraw the bucket and are held back only while the server
+// blocks the group. Not thread safe.
+class RateLimiter
+{
+ public:
+  using Clock     = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  enum class Priority
+  {
+    kHigh,
+    kLow
+  };
+
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  explicit RateLimiter(const std::vector<config::RateLimit>& limits)
+  {
+    const auto now = Clock::now();
+    for (const auto& limit : limits)
+    {
+      if (0 == limit.capacity || limit.period <= 0 ||
+          limit.reserve >= limit.capacity)
+      {
+        throw std::invalid_argument{"invalid rate limit of group " +
+                                    limit.group};
+      }
+      Bucket bucket;
+      bucket.group       = limit.group;
+      bucket.remaining   = "x-ratelimit-remaining-" + limit.group;
+      bucket.capacity    = "x-ratelimit-capacity-" + limit.group;
+      bucket.retry_after = "x-ratelimit-retry-after-" + limit.group;
+      bucket.period      = limit.period;
+      bucket.size        = limit.capacity;
+      bucket.reserve     = limit.reserve;
+      bucket.tokens      = limit.capacity;
+      bucket.refilled    = now;
+      buckets_.push_back(std::move(bucket));
+    }
+  }
+
+  // Index of the group, npos if it has no limit
+  inline std::size_t Group(std::string_view group) const
+  {
+    for (std::size_t i = 0; i < buckets_.size(); ++i)
+    {
+      if (group == buckets_[i].group)
+      {
+        return i;
+      }
+    }
+    return npos;
+  }
+
+  // Take a token for a request sent now, false if it should wait
+  inline bool TryAcquire(std::size_t group, Priority priority, TimePoint now)
+  {
+    auto& bucket = Refill(group, now);
+    if (now < bucket.blocked_until ||
+        (Priority::kLow == priority && bucket.tokens < bucket.reserve + 1))
+    {
+      return false;
+    }
+    bucket.tokens -= 1;
+    return true;
+  }
+
+  // Earliest time a low priority request could take a token, with ahead
+  // requests of the group waiting before it
+  inline TimePoint Available(
+      std::size_t group, std::size_t ahead, TimePoint now)
+  {
+    auto& bucket       = Refill(group, now);
+    const auto missing = bucket.reserve + 1 + ahead - bucket.tokens;
+    auto available     = now;
+    if (missing > 0)
+    {
+      available += std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>{missing * bucket.period / bucket.size});
+    }
+    return std::max(available, bucket.blocked_until);
+  }
+
+  // Follow the rate limit headers of a response, a 429 without them empties
+  // the bucket
+  inline void Update(std::size_t group, const Response& response, TimePoint now)
+  {
+    auto& bucket = Refill(group, now);
+    int64_t value{0};
+    if (Header(response, bucket.capacity, value) && value > 0)
+    {
+      bucket.size = static_cast<uint32_t>(value);
+      bucket.tokens =
+          std::min(bucket.tokens, static_cast<double>(bucket.size));
+    }
+    if (Header(response, bucket.remaining, value))
+    {
+      bucket.tokens = std::min(bucket.tokens, static_cast<double>(value));
+    }
+    const bool blocked = Header(response, bucket.retry_after, value);
+    if (blocked && value > 0)
+    {
+      bucket.blocked_until = now + std::chrono::seconds{value};
+    }
+    if (blocked ||
+        boost::beast::http::status::too_many_requests == response.result())
+    {
+      bucket.tokens = std::min(bucket.tokens, 0.0);
+    }
+  }
+
+  inline RateBudget Budget(std::size_t group, TimePoint now)
+  {
+    const auto& bucket = Refill(group, now);
+    RateBudget budget;
+    budget.tokens   = bucket.tokens;
+    budget.capacity = bucket.size;
+    budget.reserve  = bucket.reserve;
+    if (now < bucket.blocked_until)
+    {
+      budget.blocked_for =
+          std::chrono::duration<double>{bucket.blocked_until - now}.count();
+    }
+    return budget;
+  }
+
+ private:
+  struct Bucket
+  {
+    std::string group;
+    // header names
+    std::string remaining;
+    std::string capacity;
+    std::string retry_after;
+    double period    = 0;
+    uint32_t size    = 0;
+    uint32_t reserve = 0;
+    double tokens    = 0;
+    TimePoint refilled;
+    TimePoint blocked_until;
+  };
+
+  inline Bucket& Refill(std::size_t group, TimePoint now)
+  {
+    auto& bucket = buckets_.at(group);
+    if (now > bucket.refilled)
+    {
+      const auto elapsed =
+          std::chrono::duration<double>{now - bucket.refilled}.count();
+      bucket.tokens = std::min<double>(
+          bucket.size, bucket.tokens + elapsed * bucket.size / bucket.period);
+      bucket.refilled = now;
+    }
+    return bucket;
+  }
+
+  static inline bool Header(
+      const Response& response, const std::string& name, int64_t& value)
+  {
+    const auto it = response.find(name);
+    if (response.end() == it)
+    {
+      return false;
+    }
+    const auto text = it->value();
+    return std::errc{} ==
+           std::from_chars(text.data(), text.data() + text.size(), value).ec;
+  }
+
+ private:
+  std::vector<Bucket> buckets_;
+};
+
+} // namespace phemex::common::net::tcp::http
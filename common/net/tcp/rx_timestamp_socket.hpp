@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core/async_base.hpp>
+
+#ifdef __linux__
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <sys/socket.h>
+#endif
+
+namespace phemex::common::net::tcp
+{
+// Tcp socket which, once enabled, reads through recvmsg() to pick up the
+// kernel software receive timestamp (SO_TIMESTAMPING) of the data. Reads go
+// straight to the plain socket until then.
+class RxTimestampSocket : public boost::asio::ip::tcp::socket
+{
+ public:
+  using Base = boost::asio::ip::tcp::socket;
+
+  explicit RxTimestampSocket(Base&& socket) : Base{std::move(socket)}
+  {
+  }
+
+  // Ask the kernel to stamp received data, once connected
+  inline bool EnableRxTimestamps(boost::system::error_code& ec)
+  {
+#if defined(__linux__) && defined(SO_TIMESTAMPING)
+    const int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (0 != ::setsockopt(
+                 native_handle(), SOL_SOCKET, SO_TIMESTAMPING, &flags,
+                 sizeof(flags)))
+    {
+      ec = {errno, boost::asio::error::get_system_category()};
+      return false;
+    }
+    enabled_ = true;
+    return true;
+#else
+    ec = boost::asio::error::operation_not_supported;
+    return false;
+#endif
+  }
+
+  // nanoseconds since epoch at which the kernel received the data of the
+  // last read, 0 if unknown
+  inline int64_t RxTimestamp() const
+  {
+    return rx_timestamp_;
+  }
+
+  template <class MutableBufferSequence, class ReadHandler>
+  BOOST_ASIO_INITFN_RESULT_TYPE(
+      ReadHandler, void(boost::system::error_code, std::size_t))
+  async_read_some(const MutableBufferSequence& buffers, ReadHandler&& handler)
+  {
+#ifdef __linux__
+    if (enabled_)
+    {
+      boost::asio::async_completion<
+          ReadHandler, void(boost::system::error_code, std::size_t)>
+          init{handler};
+      ReadOp<
+          MutableBufferSequence,
+          typename decltype(init)::completion_handler_type>{
+          *this, buffers, std::move(init.completion_handler)};
+      return init.result.get();
+    }
+#endif
+    return Base::async_read_some(buffers, std::forward<ReadHandler>(handler));
+  }
+
+ private:
+#ifdef __linux__
+  // Wait until readable, then read with the control messages
+  template <class Buffers, class Handler>
+  class ReadOp : public boost::beast::async_base<Handler, Base::executor_type>
+  {
+   public:
+    ReadOp(RxTimestampSocket& socket, const Buffers& buffers, Handler&& handler)
+      : boost::beast::async_base<Handler, Base::executor_type>{
+            std::move(handler), socket.get_executor()},
+        socket_{socket},
+        buffers_{buffers}
+    {
+      socket_.async_wait(Base::wait_read, std::move(*this));
+    }
+
+    void operator()(boost::system::error_code ec)
+    {
+      std::size_t bytes = 0;
+      if (!ec)
+      {
+        bytes = socket_.Receive(buffers_, ec);
+        if (boost::asio::error::would_block == ec)
+        {
+          socket_.async_wait(Base::wait_read, std::move(*this));
+          return;
+        }
+      }
+      this->complete_now(ec, bytes);
+    }
+
+   private:
+    RxTimestampSocket& socket_;
+    Buffers buffers_;
+  };
+
+  template <class Buffers>
+  std::size_t Receive(const Buffers& buffers, boost::system::error_code& ec)
+  {
+    std::array<iovec, 16> iov;
+    std::size_t count = 0;
+    for (auto it  = boost::asio::buffer_sequence_begin(buffers),
+              end = boost::asio::buffer_sequence_end(buffers);
+         it != end && count < iov.size(); ++it)
+    {
+      const boost::asio::mutable_buffer buffer{*it};
+      if (buffer.size() > 0)
+      {
+        iov[count].iov_base = buffer.data();
+        iov[count].iov_len  = buffer.size();
+        ++count;
+      }
+    }
+    if (0 == count)
+    {
+      ec = {};
+      return 0;
+    }
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(scm_timestamping))];
+    msghdr msg{};
+    msg.msg_iov        = iov.data();
+    msg.msg_iovlen     = count;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+
+    const auto bytes = ::recvmsg(native_handle(), &msg, MSG_DONTWAIT);
+    if (bytes < 0)
+    {
+      ec = {errno, boost::asio::error::get_system_category()};
+      return 0;
+    }
+    if (0 == bytes)
+    {
+      ec = boost::asio::error::eof;
+      return 0;
+    }
+
+    for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+      if (SOL_SOCKET == cmsg->cmsg_level &&
+          SO_TIMESTAMPING == cmsg->cmsg_type)
+      {
+        scm_timestamping stamps;
+        std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+        rx_timestamp_ = stamps.ts[0].tv_sec * int64_t{1000000000} +
+                        stamps.ts[0].tv_nsec;
+      }
+    }
+    ec = {};
+    return static_cast<std::size_t>(bytes);
+  }
+#endif
+
+ private:
+  bool enabled_         = false;
+  int64_t rx_timestamp_ = 0;
+};
+
+} // namespace phemex::common::net::tcp
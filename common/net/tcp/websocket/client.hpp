@@ -1,23 +1,32 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
-#include <queue>
 
+#include <boost/asio/bind_executor.hpp>
 #include <boost/asio/buffer.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/beast/core.hpp>
 
+#include "common/chrono/latency.hpp"
+#include "common/chrono/time.hpp"
 #include "common/config/websocket_client.hpp"
+#include "common/journal/journal.hpp"
 #include "common/log.hpp"
 #include "common/net/address_book.hpp"
+#include "common/net/endpoint_cache.hpp"
+#include "common/net/endpoint_ranking.hpp"
 #include "common/net/ssl_context.hpp"
+#include "common/net/tcp/websocket/connection_pool.hpp"
 #include "common/net/tcp/websocket/ssl_connection.hpp"
 #include "common/net/utils.hpp"
+#include "common/net/write_lanes.hpp"
 
 namespace phemex::common::net::tcp::websocket
 {
 template <class Parser, class Connection = SSLConnection>
-class Client : public SSLContext, public AddressBook
+class Client : public AddressBook
 {
  public:
   using Self          = Client<Parser, Connection>;
@@ -27,22 +36,41 @@ class Client : public SSLContext, public AddressBook
 
   Client(
       boost::asio::io_context& ioc, const config::WebsocketClient& conf,
-      bool start = true)
-    : SSLContext{context::sslv23_client},
-      AddressBook{conf.addr},
-      connection_{std::make_shared<Connection>(
-          boost::asio::ip::tcp::socket{ioc}, AddressBook::Url(),
-          SSLContext::Context(), AddressBook::UseSSL())},
+      bool start = true,
+      std::shared_ptr<SSLContext> ssl_context = SSLContext::Shared())
+    : AddressBook{MakeAddressBook(conf)},
+      ssl_context_{std::move(ssl_context)},
+      pool_{
+          conf.spare_connections, conf.read_buffer_size,
+          [this, &ioc]() {
+            return std::make_shared<Connection>(
+                boost::asio::ip::tcp::socket{ioc}, AddressBook::Url(),
+                ssl_context_->Context(), AddressBook::UseSSL());
+          }},
+      connection_{pool_.Acquire(AddressBook::Url())},
       parser_{static_cast<Parser*>(this)},
       strand_{ioc},
       conf_{conf},
+      writing_queue_{
+          conf.write_queue_size, conf.weighted_writes, conf.write_weights},
       writing_{false},
       closed_{false},
-      reconnect_interval_{conf.reconnect_interval}
+      reconnect_interval_{conf.reconnect_interval},
+      endpoint_cache_{std::chrono::duration<double>{conf.dns_ttl}},
+      ranking_{AddressBook::Size(), conf.rtt_smoothing},
+      monitor_timer_{ioc},
+      probe_timer_{ioc},
+      refresh_timer_{ioc}
   {
     static_assert(
         std::is_base_of<Client, Parser>::value,
         "class Client should be derived by an message parser class");
+    if (!conf_.journal.directory.empty())
+    {
+      journal_ = journal::Journal::Shared(conf_.journal);
+      capture_ = journal_->NewCapture();
+    }
+    pool_.Refill();
     if (start)
     {
       Start();
@@ -59,6 +87,17 @@ class Client : public SSLContext, public AddressBook
     });
     boost::asio::spawn(
         strand_, [this](boost::asio::yield_context yield) { Monitor(yield); });
+    if (endpoint_cache_.Enabled())
+    {
+      boost::asio::spawn(strand_, [this](boost::asio::yield_context yield) {
+        RefreshEndpoints(yield);
+      });
+    }
+    if (ProbingEnabled())
+    {
+      boost::asio::spawn(
+          strand_, [this](boost::asio::yield_context yield) { Probe(yield); });
+    }
   }
 
   inline auto UseSSL() const
@@ -105,9 +144,20 @@ class Client : public SSLContext, public AddressBook
     BOOST_LOG(client_lg) << "stop websocket client connection to "
                          << RemoteUrl();
     closed_ = true;
+    // the close ends a pending read, the loops then see closed_ and return
+    boost::asio::spawn(strand_, [this](boost::asio::yield_context yield) {
+      monitor_timer_.cancel();
+      probe_timer_.cancel();
+      refresh_timer_.cancel();
+      if (connection_->IsOpen())
+      {
+        Close(yield);
+      }
+    });
   }
 
-  void Write(std::string message)
+  // Queue the message on its lane, urgent lanes are written first
+  void Write(std::string message, Lane lane = Lane::kControl)
   {
     if (closed_)
     {
@@ -115,8 +165,13 @@ class Client : public SSLContext, public AddressBook
     }
 
     // Write data
-    boost::asio::post(strand_, [this, message = std::move(message)]() {
-      writing_queue_.push(std::move(message));
+    auto write = [this, lane, message = std::move(message)]() mutable {
+      if (!writing_queue_.Push(lane, std::move(message)))
+      {
+        BOOST_LOG_SEV(client_lg, error)
+            << "writing queue is full, drop message to " << RemoteUrl();
+        return;
+      }
       if (writing_)
       {
         return;
@@ -125,7 +180,32 @@ class Client : public SSLContext, public AddressBook
           strand_, [this](boost::asio::yield_context yield) mutable {
             HandleWrite(yield);
           });
-    });
+    };
+    boost::asio::post(strand_, std::move(write));
+  }
+
+  // Read on the thread of the client
+  inline const auto& WriteStats(Lane lane) const
+  {
+    return writing_queue_.Stats(lane);
+  }
+
+  // Read on the thread of the client
+  inline const auto& TLSHandshakeStats() const
+  {
+    return handshake_stats_;
+  }
+
+  // Read on the thread of the client
+  inline const auto& Ranking() const
+  {
+    return ranking_;
+  }
+
+  // Frames not captured because the journal ring was full
+  inline uint64_t CaptureDropped() const
+  {
+    return capture_ ? capture_->Dropped() : 0;
   }
 
   inline auto LastUpdate() const
@@ -139,6 +219,12 @@ class Client : public SSLContext, public AddressBook
   }
 
  protected:
+  // Serializes the client's work, parser callbacks run on it
+  inline auto& Strand()
+  {
+    return strand_;
+  }
+
   void Close(boost::asio::yield_context yield)
   {
     BOOST_LOG(client_lg) << "close server connection, remote endpoint: "
@@ -160,9 +246,49 @@ class Client : public SSLContext, public AddressBook
     }
 
     // reset socket & context
-    connection_ = std::make_shared<Connection>(
-        boost::asio::ip::tcp::socket{strand_.context()}, AddressBook::Url(),
-        SSLContext::Context(), AddressBook::UseSSL());
+    ResetConnection();
+  }
+
+  static inline std::vector<config::HostAddress> MakeAddressBook(
+      const config::WebsocketClient& conf)
+  {
+    std::vector<config::HostAddress> book{conf.addr};
+    book.insert(
+        book.end(), conf.fallback_addrs.begin(), conf.fallback_addrs.end());
+    return book;
+  }
+
+  // A spare connection, the pool is topped up once the caller yields
+  inline ConnectionPtr NewConnection(const std::string& url)
+  {
+    auto connection = pool_.Acquire(url);
+    RefillPool();
+    return connection;
+  }
+
+  inline void RefillPool()
+  {
+    if (refilling_)
+    {
+      return;
+    }
+    refilling_ = true;
+    boost::asio::post(strand_, [this]() {
+      refilling_ = false;
+      pool_.Refill();
+    });
+  }
+
+  // Connections out of use are freed later, off the connect path
+  inline void RetireConnection(const ConnectionPtr& connection)
+  {
+    pool_.Retire(connection);
+  }
+
+  inline void ResetConnection()
+  {
+    RetireConnection(connection_);
+    connection_ = NewConnection(AddressBook::Url());
   }
 
   void HandleWrite(boost::asio::yield_context yield)
@@ -174,23 +300,33 @@ class Client : public SSLContext, public AddressBook
     writing_ = true;
 
     boost::system::error_code ec;
+    ConnectionPtr corked;
 
     while (!closed_)
     {
       auto connection = connection_;
-      if (!connection->IsOpen() || writing_queue_.empty())
+      if (!connection->IsOpen() || writing_queue_.Empty())
       {
         break;
       }
 
-      auto message = writing_queue_.front();
-      writing_queue_.pop();
+      // let the kernel pack a backlog of frames into full tcp segments
+      if (!corked && writing_queue_.Size() > 1)
+      {
+        connection->Cork(true);
+        corked = connection;
+      }
+
+      // the message stays in its slot until sent, pushes go to the tail
+      auto& message = writing_queue_.Front();
       if (message.empty())
       {
+        writing_queue_.Pop();
         break;
       }
 
       connection->Write(boost::asio::buffer(message), yield[ec]);
+      writing_queue_.Pop();
       if (ec)
       {
         Fail(ec, "write");
@@ -198,90 +334,315 @@ class Client : public SSLContext, public AddressBook
         break;
       }
     }
+
+    if (corked && corked->IsOpen())
+    {
+      corked->Cork(false);
+    }
     writing_ = false;
   }
 
-  void Connect(boost::asio::yield_context yield)
+  struct RaceCandidate
   {
-    using boost::asio::ip::tcp;
-    boost::system::error_code ec;
+    std::size_t index;
+    EndpointCache::Endpoints endpoints;
+  };
 
+  // connect race shared by its attempts, done is cancelled when finished
+  struct Race
+  {
+    Race(boost::asio::io_context& ioc, std::size_t attempts)
+      : done{ioc, boost::asio::steady_timer::time_point::max()},
+        attempts(attempts),
+        pending{attempts}
+    {
+    }
+
+    boost::asio::steady_timer done;
+    std::vector<ConnectionPtr> attempts;
+    std::size_t pending;
+    ConnectionPtr winner;
+    std::size_t index = 0;
+  };
+
+  void Connect(boost::asio::yield_context yield)
+  {
     while (!closed_)
     {
-      auto connection = connection_;
-      if (connection->IsOpen())
+      if (connection_->IsOpen())
       {
         return;
       }
 
-      // assign next remote end point if available
-      UseNextAddress();
-
-      BOOST_LOG(client_lg) << "start to connect " << RemoteUrl();
-      if (!SetSNIHostname(connection, yield, ec))
+      const auto connected =
+          conf_.connect_race_width > 1 ? RaceConnect(yield)
+                                       : SerialConnect(yield);
+      if (!connected)
       {
-        Fail(ec, "set_sni");
-        Close(yield);
         AsyncWait(strand_, yield, reconnect_interval_);
         continue;
       }
 
-      tcp::resolver resolver(strand_.context());
+      BOOST_LOG(client_lg) << "connected to " << RemoteUrl();
+      // callback on connection established
+      parser_->OnConnected();
+      return;
+    }
+  }
+
+  // Connect to the next address of the book
+  bool SerialConnect(boost::asio::yield_context yield)
+  {
+    // assign next remote end point if available, start with the first one,
+    // prefer the fastest probed one
+    if (attempted_)
+    {
+      if (ProbingEnabled())
+      {
+        AddressBook::Use(ranking_.Best(
+            (AddressBook::Index() + 1) % AddressBook::Size()));
+      }
+      else
+      {
+        UseNextAddress();
+      }
+    }
+    attempted_ = true;
+
+    const auto index = AddressBook::Index();
+    const auto& addr = AddressBook::Current();
+    BOOST_LOG(client_lg) << "start to connect " << addr.url;
 
-      tcp::resolver::query query(
-          tcp::v4(), RemoteHost(), std::to_string(RemotePort()));
+    boost::system::error_code ec;
+    const auto* endpoints = ResolveEndpoints(addr, yield, ec);
+    if (!endpoints)
+    {
+      Fail(ec, "resolve", addr.url);
+      ranking_.AddFailure(index);
+      return false;
+    }
 
-      tcp::resolver::iterator endpoint_iterator =
-          resolver.async_resolve(query, yield[ec]);
-      if (ec)
+    if (!Establish(connection_, index, *endpoints, yield))
+    {
+      ResetConnection();
+      return false;
+    }
+    return true;
+  }
+
+  // Start staggered attempts to several resolved addresses and configured
+  // endpoints at once, keep the first to finish and cancel the others
+  bool RaceConnect(boost::asio::yield_context yield)
+  {
+    // candidates in order of preference of the book, fastest first if probed
+    std::vector<RaceCandidate> candidates;
+    for (const auto index : ranking_.Order())
+    {
+      if (candidates.size() >= conf_.connect_race_width)
       {
-        Fail(ec, "resolve");
-        AsyncWait(strand_, yield, reconnect_interval_);
-        continue;
+        break;
       }
+      const auto& addr = AddressBook::At(index);
 
-      connection->Connect(endpoint_iterator, yield[ec]);
-      if (ec)
+      boost::system::error_code ec;
+      const auto* endpoints = ResolveEndpoints(addr, yield, ec);
+      if (!endpoints)
       {
-        Fail(ec, "connect");
-        AsyncWait(strand_, yield, reconnect_interval_);
+        Fail(ec, "resolve", addr.url);
+        ranking_.AddFailure(index);
         continue;
       }
 
-      connection->SSLHandShake(
-          boost::asio::ssl::stream_base::client, yield, ec);
-      if (ec)
+      for (const auto& endpoint : *endpoints)
       {
-        Fail(ec, "ssl handshake");
-        AsyncWait(strand_, yield, reconnect_interval_);
-        continue;
+        if (candidates.size() >= conf_.connect_race_width)
+        {
+          break;
+        }
+        candidates.push_back({index, {endpoint}});
       }
+    }
 
-      connection->HandShake(strand_, RemoteHost(), RemotePath(), yield, ec);
-      if (ec)
+    if (candidates.empty())
+    {
+      return false;
+    }
+
+    BOOST_LOG(client_lg) << "start to race " << candidates.size()
+                         << " connection attempts";
+    auto race = std::make_shared<Race>(strand_.context(), candidates.size());
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+    {
+      boost::asio::spawn(
+          strand_, [this, race, i, candidate = std::move(candidates[i])](
+                       boost::asio::yield_context yield) {
+            RaceAttempt(race, i, candidate, yield);
+          });
+    }
+
+    // cancelled by the winner or the last failed attempt
+    boost::system::error_code ec;
+    race->done.async_wait(yield[ec]);
+    for (const auto& attempt : race->attempts)
+    {
+      if (attempt && attempt != race->winner)
       {
-        Fail(ec, "handshake");
-        AsyncWait(strand_, yield, reconnect_interval_);
-        continue;
+        RetireConnection(attempt);
       }
+    }
+    if (!race->winner)
+    {
+      return false;
+    }
 
-      BOOST_LOG(client_lg) << "connected to " << RemoteUrl();
-      // callback on connection established
-      parser_->OnConnected();
-      return;
+    AddressBook::Use(race->index);
+    RetireConnection(connection_);
+    connection_ = race->winner;
+    return true;
+  }
+
+  void RaceAttempt(
+      const std::shared_ptr<Race>& race, std::size_t order,
+      const RaceCandidate& candidate, boost::asio::yield_context yield)
+  {
+    if (order > 0)
+    {
+      AsyncWait(
+          strand_, yield,
+          std::chrono::duration<double>{conf_.connect_race_stagger * order});
+    }
+
+    if (!race->winner && !closed_)
+    {
+      const auto& addr      = AddressBook::At(candidate.index);
+      auto connection       = NewConnection(addr.url);
+      race->attempts[order] = connection;
+
+      if (Establish(connection, candidate.index, candidate.endpoints, yield))
+      {
+        if (!race->winner)
+        {
+          race->winner = connection;
+          race->index  = candidate.index;
+        }
+
+        // cancel the attempts still in flight and close late finishers
+        for (auto& attempt : race->attempts)
+        {
+          if (attempt && attempt != race->winner)
+          {
+            boost::system::error_code ec;
+            attempt->Close(ec);
+          }
+        }
+      }
+    }
+
+    if (0 == --race->pending || race->winner)
+    {
+      race->done.cancel();
     }
   }
 
+  // Run tcp, tls and websocket handshakes of one connection attempt to an
+  // entry of the book, the connection is closed on failure. Only session
+  // connections count in the tls handshake stats, not probes.
+  bool Establish(
+      const ConnectionPtr& connection, std::size_t index,
+      const EndpointCache::Endpoints& endpoints,
+      boost::asio::yield_context yield, bool session = true)
+  {
+    const auto& addr = AddressBook::At(index);
+    const auto abort = [&](const auto& ec, std::string_view what) {
+      return Abort(connection, index, ec, what, yield);
+    };
+
+    boost::system::error_code ec;
+    if (!SetSNIHostname(connection, addr.host, ec))
+    {
+      return abort(ec, "set_sni");
+    }
+
+    connection->Connect(endpoints, yield[ec]);
+    if (ec)
+    {
+      // addresses may have changed, refresh them off the connect path
+      ExpireEndpoints(addr);
+      return abort(ec, "connect");
+    }
+
+    connection->Tune(conf_.socket);
+    BOOST_LOG_SEV(client_lg, debug)
+        << "tuned socket to " << addr.url << "\n"
+        << connection->Options().ToString();
+
+    connection->PrepareSession(*ssl_context_, addr.url);
+    const auto handshake_start = std::chrono::steady_clock::now();
+    connection->SSLHandShake(boost::asio::ssl::stream_base::client, yield, ec);
+    if (ec)
+    {
+      return abort(ec, "ssl handshake");
+    }
+
+    const auto handshake_time = std::chrono::steady_clock::now() -
+                                handshake_start;
+    const auto resumed = connection->SessionReused();
+    if (session)
+    {
+      handshake_stats_.Add(handshake_time, resumed);
+    }
+    BOOST_LOG_SEV(client_lg, debug)
+        << "tls handshake with " << addr.url << " took "
+        << std::chrono::duration_cast<std::chrono::microseconds>(
+               handshake_time)
+               .count()
+        << "us, resumed: " << resumed;
+
+    // the upgrade is a single request and response, a clean rtt sample
+    const auto upgrade_start = std::chrono::steady_clock::now();
+    connection->HandShake(strand_, addr.host, addr.path, yield, ec);
+    if (ec)
+    {
+      return abort(ec, "handshake");
+    }
+    ranking_.AddHandshakeRtt(
+        index, std::chrono::steady_clock::now() - upgrade_start);
+    return true;
+  }
+
+  inline bool Abort(
+      const ConnectionPtr& connection, std::size_t index,
+      const boost::system::error_code& ec, std::string_view what,
+      boost::asio::yield_context yield)
+  {
+    // attempts cancelled after losing a race are not failures
+    if (boost::asio::error::operation_aborted != ec)
+    {
+      Fail(ec, what, AddressBook::At(index).url);
+      ranking_.AddFailure(index);
+    }
+
+    boost::system::error_code close_ec;
+    connection->Close(yield, close_ec);
+    return false;
+  }
+
   void HandleRead(boost::asio::yield_context yield)
   {
     boost::system::error_code ec;
     // Init connection
     Connect(yield);
 
-    // Loop to read data from server
+    // Loop to read data from server, the reference is only taken again
+    // once the connection is replaced
+    auto connection = connection_;
     while (!closed_)
     {
-      auto connection = connection_;
+      if (connection != connection_)
+      {
+        connection = connection_;
+        RefillPool();
+      }
       if (!connection->IsOpen())
       {
         AsyncWait(strand_, yield);
@@ -293,6 +654,11 @@ class Client : public SSLContext, public AddressBook
       connection->Read(data, yield, ec);
       if (ec)
       {
+        // the connection was replaced by a migration and closed on purpose
+        if (connection != connection_)
+        {
+          continue;
+        }
         if (!connection->GracefullyClosed(ec))
         {
           Fail(ec, "read data from");
@@ -312,37 +678,292 @@ class Client : public SSLContext, public AddressBook
       if (!data.empty())
       {
         connection->SetLastUpdate();
+        StampRead(*connection);
+        CaptureFrame(*connection, data);
         parser_->Parse(RemoteUrl(), std::move(data));
       }
     }
   }
 
+  // Sleep until the next ping or the read deadline, whichever comes first.
+  // Reads only stamp LastUpdate(), the deadline moves when the timer fires
+  // and finds newer data, so a busy connection costs no timer operations.
   void Monitor(boost::asio::yield_context yield)
   {
-    if (0 == conf_.timeout)
+    using std::chrono::duration_cast;
+    using Duration = std::chrono::steady_clock::duration;
+
+    const auto timeout = duration_cast<Duration>(
+        std::chrono::duration<double>{conf_.timeout});
+    const auto ping_interval = duration_cast<Duration>(
+        std::chrono::duration<double>{conf_.ping_interval});
+    if (timeout <= Duration::zero() && ping_interval <= Duration::zero())
     {
       return;
     }
 
+    auto next_ping = std::chrono::steady_clock::now() + ping_interval;
     while (!closed_)
     {
-      AsyncWait(strand_, yield, std::chrono::seconds{1});
-
-      // Close session if no data update before session timed out
       auto connection = connection_;
-      auto now        = std::chrono::system_clock::now();
-      auto time_diff  = std::chrono::duration_cast<std::chrono::seconds>(
-                           now - connection->LastUpdate())
-                           .count();
+      const auto now  = std::chrono::steady_clock::now();
+      auto wake       = Duration::max();
 
-      connection->Monitor(yield);
+      if (ping_interval > Duration::zero())
+      {
+        if (now >= next_ping)
+        {
+          connection->Monitor(yield);
+          next_ping = now + ping_interval;
+        }
+        wake = next_ping - now;
+      }
 
-      if (connection->IsOpen() && time_diff > conf_.timeout)
+      if (timeout > Duration::zero())
       {
-        BOOST_LOG_SEV(client_lg, error)
-            << "connection timeout after " << conf_.timeout
-            << "s, remote endpoint: " << RemoteUrl();
-        Close(yield);
+        const auto idle = duration_cast<Duration>(
+            std::chrono::system_clock::now() - connection->LastUpdate());
+        if (connection->IsOpen() && idle >= timeout)
+        {
+          BOOST_LOG_SEV(client_lg, error)
+              << "connection timeout after " << conf_.timeout
+              << "s, remote endpoint: " << RemoteUrl();
+          Close(yield);
+          continue;
+        }
+        // a new connection starts its idle time at connect, not earlier
+        // than the wake up
+        wake = std::min(
+            wake, connection->IsOpen() ? timeout - idle : timeout);
+      }
+
+      boost::system::error_code ec;
+      monitor_timer_.expires_after(wake);
+      monitor_timer_.async_wait(yield[ec]);
+    }
+  }
+
+  // Receive and read completion time of the message handed to the parser on
+  // the local clock, only taken when recording latency or estimating the
+  // exchange clock
+  inline void StampRead(const Connection& connection)
+  {
+    if (conf_.record_latency || conf_.estimate_clock_offset)
+    {
+      read_times_.receive = connection.RxTimestamp();
+      read_times_.read    = chrono::Time::Now<std::chrono::nanoseconds>();
+    }
+  }
+
+  inline const auto& ReadTimes() const
+  {
+    return read_times_;
+  }
+
+  // Copy the frame into the journal ring, stamped with the kernel receive
+  // time if taken
+  inline void CaptureFrame(const Connection& connection, std::string_view data)
+  {
+    if (!capture_)
+    {
+      return;
+    }
+
+    auto timestamp = connection.RxTimestamp();
+    if (0 == timestamp)
+    {
+      timestamp = 0 != read_times_.read
+                      ? read_times_.read
+                      : chrono::Time::Now<std::chrono::nanoseconds>();
+    }
+    capture_->Append(connection.Id(), timestamp, data);
+  }
+
+  inline bool ProbingEnabled() const
+  {
+    return conf_.probe_interval > 0;
+  }
+
+  // Record an application level round trip of the current connection
+  template <class Rep, class Period>
+  inline void AddPingRtt(const std::chrono::duration<Rep, Period>& rtt)
+  {
+    ranking_.AddPingRtt(AddressBook::Index(), rtt);
+  }
+
+  // Measure every book entry but the connected one and move over to a
+  // clearly faster one
+  void Probe(boost::asio::yield_context yield)
+  {
+    while (!closed_)
+    {
+      boost::system::error_code ec;
+      probe_timer_.expires_after(
+          std::chrono::duration_cast<boost::asio::steady_timer::duration>(
+              std::chrono::duration<double>{conf_.probe_interval}));
+      probe_timer_.async_wait(yield[ec]);
+
+      for (std::size_t index = 0; index < AddressBook::Size() && !closed_;
+           ++index)
+      {
+        if (index != AddressBook::Index() || !IsAvailable())
+        {
+          ProbeEndpoint(index, yield);
+        }
+      }
+
+      std::size_t target;
+      if (!closed_ && IsAvailable() &&
+          ranking_.ShouldMigrate(
+              AddressBook::Index(), conf_.migrate_hysteresis, target))
+      {
+        Migrate(target, yield);
+      }
+    }
+  }
+
+  // Handshake with the endpoint and time one ping request of the parser on a
+  // throwaway connection
+  void ProbeEndpoint(std::size_t index, boost::asio::yield_context yield)
+  {
+    const auto& addr = AddressBook::At(index);
+
+    boost::system::error_code ec;
+    const auto* endpoints = ResolveEndpoints(addr, yield, ec);
+    if (!endpoints)
+    {
+      Fail(ec, "resolve", addr.url);
+      ranking_.AddFailure(index);
+      return;
+    }
+
+    auto connection = NewConnection(addr.url);
+    boost::asio::steady_timer deadline{
+        strand_.context(),
+        std::chrono::duration_cast<boost::asio::steady_timer::duration>(
+            std::chrono::duration<double>{conf_.probe_timeout})};
+    deadline.async_wait(boost::asio::bind_executor(
+        strand_, [connection](const boost::system::error_code& ec) {
+          if (!ec)
+          {
+            boost::system::error_code close_ec;
+            connection->Close(close_ec);
+          }
+        }));
+
+    if (Establish(connection, index, *endpoints, yield, false))
+    {
+      const auto ping_start = std::chrono::steady_clock::now();
+      connection->Write(
+          boost::asio::buffer(parser_->ProbeRequest()), yield[ec]);
+      while (!ec)
+      {
+        std::string data{};
+        connection->Read(data, yield, ec);
+        if (!ec && parser_->IsProbeReply(data))
+        {
+          ranking_.AddPingRtt(
+              index, std::chrono::steady_clock::now() - ping_start);
+          break;
+        }
+      }
+      if (ec)
+      {
+        Fail(ec, "probe", addr.url);
+        ranking_.AddFailure(index);
+      }
+      connection->Close(yield, ec);
+    }
+    deadline.cancel();
+    RetireConnection(connection);
+
+    const auto& latency = ranking_.At(index);
+    BOOST_LOG_SEV(client_lg, debug)
+        << "probed " << addr.url << ", handshake rtt "
+        << latency.handshake_rtt << "us, ping rtt " << latency.ping_rtt
+        << "us, failures " << latency.failures;
+  }
+
+  // Connect to the book entry before leaving the current connection, the
+  // subscriptions are sent again on the new one
+  void Migrate(std::size_t index, boost::asio::yield_context yield)
+  {
+    const auto& addr = AddressBook::At(index);
+    BOOST_LOG(client_lg) << "migrate from " << RemoteUrl() << " ("
+                         << ranking_.Score(AddressBook::Index()) << "us) to "
+                         << addr.url << " (" << ranking_.Score(index)
+                         << "us)";
+
+    boost::system::error_code ec;
+    const auto* endpoints = ResolveEndpoints(addr, yield, ec);
+    if (!endpoints)
+    {
+      Fail(ec, "resolve", addr.url);
+      ranking_.AddFailure(index);
+      return;
+    }
+
+    auto connection = NewConnection(addr.url);
+    if (!Establish(connection, index, *endpoints, yield) || closed_)
+    {
+      RetireConnection(connection);
+      return;
+    }
+
+    auto previous = connection_;
+    AddressBook::Use(index);
+    connection_ = connection;
+    BOOST_LOG(client_lg) << "connected to " << RemoteUrl();
+    parser_->OnConnected();
+
+    previous->Close(yield, ec);
+    RetireConnection(previous);
+  }
+
+  // Cached endpoints of the remote host, the resolver is only used on the
+  // first connect or if caching is disabled. nullptr with ec set if there
+  // are none.
+  inline const EndpointCache::Endpoints* ResolveEndpoints(
+      const config::HostAddress& addr, boost::asio::yield_context yield,
+      boost::system::error_code& ec)
+  {
+    if (endpoint_cache_.Enabled())
+    {
+      const auto* endpoints = endpoint_cache_.Find(addr.host, addr.port);
+      if (endpoints)
+      {
+        return endpoints;
+      }
+    }
+    return endpoint_cache_.Resolve(
+        strand_.context(), addr.host, addr.port, yield, ec);
+  }
+
+  inline void ExpireEndpoints(const config::HostAddress& addr)
+  {
+    if (!endpoint_cache_.Enabled())
+    {
+      return;
+    }
+
+    endpoint_cache_.Expire(addr.host, addr.port);
+    boost::asio::spawn(strand_, [this](boost::asio::yield_context yield) {
+      endpoint_cache_.Refresh(strand_.context(), yield);
+    });
+  }
+
+  void RefreshEndpoints(boost::asio::yield_context yield)
+  {
+    while (!closed_)
+    {
+      boost::system::error_code ec;
+      refresh_timer_.expires_after(
+          std::chrono::duration_cast<boost::asio::steady_timer::duration>(
+              endpoint_cache_.Ttl()));
+      refresh_timer_.async_wait(yield[ec]);
+      if (!closed_)
+      {
+        endpoint_cache_.Refresh(strand_.context(), yield);
       }
     }
   }
@@ -350,19 +971,25 @@ class Client : public SSLContext, public AddressBook
   // Report a failure
   inline void Fail(const boost::system::error_code& ec, std::string_view what)
   {
-    BOOST_LOG_SEV(client_lg, error)
-        << "failed to " << what << " " << RemoteUrl()
-        << ", error msg=" << ec.message();
+    Fail(ec, what, RemoteUrl());
+  }
+
+  inline void Fail(
+      const boost::system::error_code& ec, std::string_view what,
+      std::string_view url)
+  {
+    BOOST_LOG_SEV(client_lg, error) << "failed to " << what << " " << url
+                                    << ", error msg=" << ec.message();
   }
 
  protected:
   inline bool SetSNIHostname(
-      const ConnectionPtr& connection, boost::asio::yield_context yield,
+      const ConnectionPtr& connection, const std::string& host,
       boost::system::error_code& ec) noexcept
   {
     if (conf_.enable_sni)
     {
-      connection->SetSNIHostname(RemoteHost(), ec);
+      connection->SetSNIHostname(host, ec);
       if (ec)
       {
         return false;
@@ -373,13 +1000,27 @@ class Client : public SSLContext, public AddressBook
   }
 
  private:
+  std::shared_ptr<SSLContext> ssl_context_;
+  ConnectionPool<Connection> pool_;
   ConnectionPtr connection_;
+  bool refilling_ = false;
   Parser* parser_;
   boost::asio::io_context::strand strand_;
   config::WebsocketClient conf_;
-  std::queue<std::string> writing_queue_;
+  WriteLanes writing_queue_;
   bool writing_;
   bool closed_;
+  bool attempted_ = false;
   std::chrono::duration<double> reconnect_interval_;
+  EndpointCache endpoint_cache_;
+  HandshakeStats handshake_stats_;
+  EndpointRanking ranking_;
+  chrono::MessageTimes read_times_;
+  std::shared_ptr<journal::Journal> journal_;
+  std::shared_ptr<journal::Journal::Capture> capture_;
+  boost::asio::steady_timer monitor_timer_;
+  // waits of the background loops, cut short by Stop()
+  boost::asio::steady_timer probe_timer_;
+  boost::asio::steady_timer refresh_timer_;
 };
 } // namespace phemex::common::net::tcp::websocket
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstring>
 #include <memory>
 
 #include <boost/asio/buffer.hpp>
@@ -13,6 +15,9 @@
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 
+#include "common/config/socket_options.hpp"
+#include "common/net/socket_options.hpp"
+
 namespace phemex::common::net::tcp::websocket
 {
 template <class S>
@@ -20,7 +25,7 @@ class Connection
 {
  public:
   using Ptr    = std::shared_ptr<Connection<S>>;
-  using Buffer = boost::beast::multi_buffer;
+  using Buffer = boost::beast::flat_buffer;
 
   template <class... Args>
   Connection(
@@ -28,7 +33,8 @@ class Connection
       Args&&... args)
     : remote_url_{url},
       ws_{std::move(socket), std::forward<Args>(args)...},
-      last_update_{std::chrono::system_clock::now()}
+      last_update_{std::chrono::system_clock::now()},
+      id_{NextId()}
   {
   }
 
@@ -36,7 +42,8 @@ class Connection
   Connection(boost::asio::ip::tcp::socket&& socket, Args&&... args)
     : remote_url_{GetRemoteUrl(socket)},
       ws_{std::move(socket), std::forward<Args>(args)...},
-      last_update_{std::chrono::system_clock::now()}
+      last_update_{std::chrono::system_clock::now()},
+      id_{NextId()}
   {
   }
 
@@ -45,6 +52,12 @@ class Connection
     return remote_url_;
   }
 
+  // Unique in the process, a reconnect gets a new one
+  inline uint32_t Id() const
+  {
+    return id_;
+  }
+
   inline void RemoteUrl(const std::string& url)
   {
     remote_url_ = url;
@@ -77,6 +90,39 @@ class Connection
     ForceClose(ec);
   }
 
+  // Hold back partial tcp segments while a batch of frames is written, the
+  // pending data is flushed when uncorked
+  inline void Cork(bool enable) noexcept
+  {
+#ifdef TCP_CORK
+    using cork =
+        boost::asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_CORK>;
+    boost::system::error_code ec;
+    ws_.next_layer().lowest_layer().set_option(cork{enable}, ec);
+#endif
+  }
+
+  // Apply the tuning profile after connect and keep the granted values
+  inline void Tune(const config::SocketOptions& conf)
+  {
+    auto& socket = ws_.next_layer().lowest_layer();
+    ApplySocketOptions(socket, conf);
+    options_   = GetSocketReport(socket);
+    quick_ack_ = conf.quick_ack;
+  }
+
+  inline const auto& Options() const
+  {
+    return options_;
+  }
+
+  // kernel receive time of the last read, nanoseconds since epoch, 0 if not
+  // supported by the stream
+  inline int64_t RxTimestamp() const
+  {
+    return 0;
+  }
+
   static inline bool GracefullyClosed(const boost::system::error_code& ec)
   {
     if (boost::beast::websocket::error::closed != ec ||
@@ -114,6 +160,7 @@ class Connection
       boost::system::error_code& ec)
   {
     Read(buffer_, yield[ec]);
+    RearmQuickAck();
     data = boost::beast::buffers_to_string(buffer_.data());
     buffer_.consume(buffer_.size());
   }
@@ -121,10 +168,30 @@ class Connection
   inline void Read(std::string& data, boost::asio::yield_context& yield)
   {
     Read(buffer_, yield);
+    RearmQuickAck();
     data = boost::beast::buffers_to_string(buffer_.data());
     buffer_.consume(buffer_.size());
   }
 
+  // Allocate the read buffer and fault its pages in before the first read
+  inline void ReserveBuffer(std::size_t size)
+  {
+    if (0 == size)
+    {
+      return;
+    }
+    const auto buffer = buffer_.prepare(size);
+    std::memset(buffer.data(), 0, buffer.size());
+  }
+
+  // Take over the read buffer of a connection out of use, its capacity is
+  // kept
+  inline void AdoptBuffer(Connection& retired)
+  {
+    buffer_ = std::move(retired.buffer_);
+    buffer_.consume(buffer_.size());
+  }
+
   inline void SetSNIHostname(
       const std::string&, boost::system::error_code&) noexcept
   {
@@ -149,6 +216,16 @@ class Connection
     last_update_ = std::chrono::system_clock::now();
   }
 
+  template <class Context>
+  inline void PrepareSession(Context&, const std::string&)
+  {
+  }
+
+  inline bool SessionReused()
+  {
+    return false;
+  }
+
   // handshake at server side
   template <class F>
   void Accept(
@@ -222,6 +299,12 @@ class Connection
   }
 
  protected:
+  static inline uint32_t NextId()
+  {
+    static std::atomic<uint32_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+  }
+
   template <class T>
   static inline std::string GetRemoteUrl(const T& socket)
   {
@@ -229,6 +312,14 @@ class Connection
            std::to_string(socket.remote_endpoint().port());
   }
 
+  inline void RearmQuickAck()
+  {
+    if (quick_ack_)
+    {
+      net::RearmQuickAck(ws_.next_layer().lowest_layer());
+    }
+  }
+
   inline void ForceClose(boost::system::error_code& ec)
   {
     if (!IsOpen())
@@ -305,5 +396,8 @@ class Connection
   S ws_;
   Buffer buffer_;
   std::chrono::system_clock::time_point last_update_;
+  SocketReport options_;
+  bool quick_ack_ = false;
+  uint32_t id_;
 };
 } // namespace phemex::common::net::tcp::websocket
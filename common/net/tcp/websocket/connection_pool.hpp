@@ -0,0 +1,107 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace phemex::common::net::tcp::websocket
+{
+// Connections built ahead of the next connect, and the retired ones kept
+// until no handler refers to them, so a reconnect neither constructs nor
+// frees connection state on its path. The read buffer of a freed connection,
+// allocated and touched already, moves to the spare built in its place. Tls
+// and socket state are built anew, a closed ssl stream can not be reset for
+// another session. Not thread safe.
+template <class Connection>
+class ConnectionPool
+{
+ public:
+  using Ptr     = typename Connection::Ptr;
+  using Factory = std::function<Ptr()>;
+
+  ConnectionPool(std::size_t spares, std::size_t buffer_size, Factory factory)
+    : spares_target_{spares},
+      buffer_size_{buffer_size},
+      factory_{std::move(factory)}
+  {
+    spares_.reserve(spares_target_);
+  }
+
+  ConnectionPool(const ConnectionPool&) = delete;
+  ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+  // A spare to the url, or a new connection if none is left
+  inline Ptr Acquire(const std::string& url)
+  {
+    Ptr connection;
+    if (spares_.empty())
+    {
+      connection = factory_();
+    }
+    else
+    {
+      connection = std::move(spares_.back());
+      spares_.pop_back();
+    }
+    connection->RemoteUrl(url);
+    connection->SetLastUpdate();
+    return connection;
+  }
+
+  // Hand back a connection out of use, it is freed by a later Refill()
+  inline void Retire(Ptr connection)
+  {
+    if (connection)
+    {
+      retired_.push_back(std::move(connection));
+    }
+  }
+
+  // Free the retired connections held by nobody else and build spares up to
+  // the target, meant to run between connects
+  void Refill()
+  {
+    for (auto it = retired_.begin(); it != retired_.end();)
+    {
+      if (1 != it->use_count() || (*it)->IsOpen())
+      {
+        ++it;
+        continue;
+      }
+      if (spares_.size() < spares_target_)
+      {
+        auto spare = factory_();
+        spare->AdoptBuffer(**it);
+        spares_.push_back(std::move(spare));
+      }
+      it = retired_.erase(it);
+    }
+
+    while (spares_.size() < spares_target_)
+    {
+      auto spare = factory_();
+      spare->ReserveBuffer(buffer_size_);
+      spares_.push_back(std::move(spare));
+    }
+  }
+
+  inline std::size_t Spares() const
+  {
+    return spares_.size();
+  }
+
+  inline std::size_t Retired() const
+  {
+    return retired_.size();
+  }
+
+ private:
+  std::size_t spares_target_;
+  std::size_t buffer_size_;
+  Factory factory_;
+  std::vector<Ptr> spares_;
+  std::vector<Ptr> retired_;
+};
+
+} // namespace phemex::common::net::tcp::websocket
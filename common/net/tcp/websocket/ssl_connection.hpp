@@ -4,13 +4,15 @@
 #include <boost/asio/ssl/stream.hpp>
 #include <boost/beast/websocket/ssl.hpp>
 
+#include "common/log.hpp"
+#include "common/net/tcp/rx_timestamp_socket.hpp"
 #include "common/net/tcp/websocket/connection.hpp"
 
 namespace phemex::common::net::tcp::websocket
 {
 class SSLConnection
   : public Connection<boost::beast::websocket::stream<
-        boost::asio::ssl::stream<boost::asio::ip::tcp::socket>>>
+        boost::asio::ssl::stream<RxTimestampSocket>>>
 {
  public:
   using Ptr    = std::shared_ptr<SSLConnection>;
@@ -40,6 +42,29 @@ class SSLConnection
         std::forward<Args>(args)...);
   }
 
+  inline void Tune(const config::SocketOptions& conf)
+  {
+    Connection::Tune(conf);
+    if (!conf.rx_timestamps)
+    {
+      return;
+    }
+
+    boost::system::error_code ec;
+    if (!Connection::Socket().next_layer().next_layer().EnableRxTimestamps(
+            ec))
+    {
+      BOOST_LOG_SEV(client_lg, warning)
+          << "failed to enable receive timestamps, remote url: "
+          << Connection::RemoteUrl() << ", reason: " << ec.message();
+    }
+  }
+
+  inline int64_t RxTimestamp() const
+  {
+    return Connection::Socket().next_layer().next_layer().RxTimestamp();
+  }
+
   inline void SetSNIHostname(
       const std::string& hostname, boost::system::error_code& ec) noexcept
   {
@@ -52,6 +77,32 @@ class SSLConnection
     }
   }
 
+  // Offer the cached tls session of the key (remote endpoint) on handshake
+  template <class Context>
+  inline void PrepareSession(Context& context, const std::string& key)
+  {
+    session_key_ = key;
+    context.PrepareSession(NativeHandle(), &session_key_);
+  }
+
+  inline bool SessionReused()
+  {
+    return 1 == SSL_session_reused(NativeHandle());
+  }
+
+  inline void Close(boost::system::error_code& ec)
+  {
+    KeepSession();
+    Connection::Close(ec);
+  }
+
+  inline void Close(
+      boost::asio::yield_context yield, boost::system::error_code& ec)
+  {
+    KeepSession();
+    Connection::Close(yield, ec);
+  }
+
   template <class HandShakeType, class... Args>
   inline void SSLHandShake(HandShakeType type, Args&&... args)
   {
@@ -66,5 +117,25 @@ class SSLConnection
   {
     Connection::Socket().next_layer().async_handshake(type, yield[ec]);
   }
+
+ private:
+  inline SSL* NativeHandle()
+  {
+    return Connection::Socket().next_layer().native_handle();
+  }
+
+  // Openssl drops a session from resumption if the connection is freed
+  // without close_notify, connections are force closed so mark it as done
+  inline void KeepSession()
+  {
+    auto* ssl = NativeHandle();
+    if (SSL_is_init_finished(ssl))
+    {
+      SSL_set_shutdown(ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    }
+  }
+
+ private:
+  std::string session_key_;
 };
 } // namespace phemex::common::net::tcp::websocket
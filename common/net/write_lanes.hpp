@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "common/chrono/histogram.hpp"
+#include "common/container/ring_queue.hpp"
+
+namespace phemex::common::net
+{
+// Outbound message classes, lower is more urgent
+enum class Lane
+{
+  // orders and other requests waiting on a reply
+  kControl,
+  kHeartbeat,
+  // subscriptions and other traffic that tolerates delay
+  kBulk
+};
+
+inline constexpr std::size_t kLanes =
+    static_cast<std::size_t>(Lane::kBulk) + 1;
+
+struct LaneStats
+{
+  // nanoseconds from push to the start of the write
+  chrono::Histogram wait;
+  std::size_t depth     = 0;
+  std::size_t max_depth = 0;
+  uint64_t dropped      = 0;
+
+  inline auto ToString(const std::string& name, int32_t indent_chars = 0) const
+  {
+    using namespace config;
+    std::ostringstream oss;
+    PutHeader(oss, indent_chars, name);
+    PutLine(oss, indent_chars + 2, "depth", depth, " (max ", max_depth, ")");
+    PutLine(oss, indent_chars + 2, "dropped", dropped);
+    oss << wait.ToString("wait", indent_chars + 2);
+    return oss.str();
+  }
+};
+
+// One bounded queue per lane. Strict scheduling always serves the most
+// urgent non-empty lane; weighted scheduling lets each lane send up to its
+// weight of messages per round, so bulk traffic keeps moving under a steady
+// stream of urgent messages. Not thread safe.
+class WriteLanes
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  WriteLanes(
+      std::size_t capacity, bool weighted,
+      const std::vector<uint32_t>& weights)
+    : lanes_{Queue{capacity}, Queue{capacity}, Queue{capacity}},
+      weighted_{weighted}
+  {
+    if (weighted_ && weights.size() != kLanes)
+    {
+      throw std::invalid_argument{"write weights should be given per lane"};
+    }
+    for (std::size_t i = 0; weighted_ && i < kLanes; ++i)
+    {
+      if (0 == weights[i])
+      {
+        throw std::invalid_argument{"write weights should be positive"};
+      }
+      weights_[i] = weights[i];
+      credits_[i] = weights[i];
+    }
+  }
+
+  inline bool Push(Lane lane, std::string&& message)
+  {
+    const auto i = static_cast<std::size_t>(lane);
+    if (!lanes_[i].Push({std::move(message), Clock::now()}))
+    {
+      ++stats_[i].dropped;
+      return false;
+    }
+    stats_[i].depth     = lanes_[i].Size();
+    stats_[i].max_depth = std::max(stats_[i].max_depth, stats_[i].depth);
+    return true;
+  }
+
+  inline bool Empty() const
+  {
+    for (const auto& lane : lanes_)
+    {
+      if (!lane.Empty())
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  inline std::size_t Size() const
+  {
+    std::size_t size = 0;
+    for (const auto& lane : lanes_)
+    {
+      size += lane.Size();
+    }
+    return size;
+  }
+
+  // Next message to write, it stays in its slot and keeps being returned
+  // until Pop(). Requires a non-empty queue.
+  inline std::string& Front()
+  {
+    if (kLanes == current_)
+    {
+      current_    = Select();
+      auto& entry = lanes_[current_].Front();
+      stats_[current_].wait.Record(
+          std::chrono::nanoseconds{Clock::now() - entry.queued}.count());
+    }
+    return lanes_[current_].Front().message;
+  }
+
+  inline void Pop()
+  {
+    if (kLanes == current_)
+    {
+      current_ = Select();
+    }
+    lanes_[current_].Pop();
+    stats_[current_].depth = lanes_[current_].Size();
+    current_               = kLanes;
+  }
+
+  inline const LaneStats& Stats(Lane lane) const
+  {
+    return stats_[static_cast<std::size_t>(lane)];
+  }
+
+ private:
+  struct Entry
+  {
+    std::string message;
+    Clock::time_point queued;
+  };
+
+  using Queue = container::RingQueue<Entry>;
+
+  inline std::size_t Select()
+  {
+    if (!weighted_)
+    {
+      for (std::size_t i = 0; i < kLanes; ++i)
+      {
+        if (!lanes_[i].Empty())
+        {
+          return i;
+        }
+      }
+      return kLanes - 1;
+    }
+
+    // a new round once no waiting lane has credit left
+    for (int round = 0; round < 2; ++round)
+    {
+      for (std::size_t i = 0; i < kLanes; ++i)
+      {
+        if (!lanes_[i].Empty() && credits_[i] > 0)
+        {
+          --credits_[i];
+          return i;
+        }
+      }
+      credits_ = weights_;
+    }
+    return kLanes - 1;
+  }
+
+ private:
+  std::array<Queue, kLanes> lanes_;
+  std::array<LaneStats, kLanes> stats_;
+  bool weighted_;
+  std::array<uint32_t, kLanes> weights_{};
+  std::array<uint32_t, kLanes> credits_{};
+  // lane of the message returned by Front(), kLanes if none
+  std::size_t current_ = kLanes;
+};
+
+} // namespace phemex::common::net
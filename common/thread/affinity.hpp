@@ -0,0 +1,38 @@
+#pragma once
+
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace phemex::common::thread
+{
+// Pin the thread to one cpu core, negative cpu leaves the thread unpinned
+inline bool SetAffinity(std::thread::native_handle_type handle, int32_t cpu)
+{
+  if (cpu < 0)
+  {
+    return true;
+  }
+#ifdef __linux__
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu, &cpuset);
+  return 0 == pthread_setaffinity_np(handle, sizeof(cpu_set_t), &cpuset);
+#else
+  return false;
+#endif
+}
+
+inline bool SetAffinity(int32_t cpu)
+{
+#ifdef __linux__
+  return SetAffinity(pthread_self(), cpu);
+#else
+  return cpu < 0;
+#endif
+}
+
+} // namespace phemex::common::thread
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <string_view>
+
+#include "common/json/scanner.hpp"
+
+namespace phemex
+{
+enum class Channel
+{
+  kUnknown,
+  kOrderBook,
+  kTrade,
+  kKline,
+  // account, order and position updates of the authenticated session
+  kAop
+};
+
+inline std::string_view ToString(Channel channel)
+{
+  switch (channel)
+  {
+  case Channel::kOrderBook:
+    return "orderbook";
+  case Channel::kTrade:
+    return "trade";
+  case Channel::kKline:
+    return "kline";
+  case Channel::kAop:
+    return "aop";
+  default:
+    return "unknown";
+  }
+}
+
+// Account-order-position messages open with one of their arrays, keys
+// sorted. Only the first key is looked at so market data is not scanned.
+inline bool IsAop(std::string_view message)
+{
+  return 0 == message.rfind("{\"accounts\"", 0) ||
+         0 == message.rfind("{\"orders\"", 0) ||
+         0 == message.rfind("{\"positions\"", 0);
+}
+
+// `{"error":..,"id":..,"result":..}`: replies are short and open with their
+// error or id, market data opens with its payload. Cheap enough to run on
+// every message before looking for the id.
+inline bool IsReply(std::string_view message)
+{
+  constexpr std::size_t kMaxReply = 512;
+  constexpr std::size_t kIdWithin = 16;
+  return message.size() <= kMaxReply &&
+         (0 == message.rfind("{\"error\"", 0) ||
+          message.substr(0, kIdWithin).find("\"id\"") !=
+              std::string_view::npos);
+}
+
+// Routing fields of a market data message, views refer to the raw message
+struct MessageHeader
+{
+  Channel channel = Channel::kUnknown;
+  std::string_view symbol;
+  int64_t sequence  = -1;
+  int64_t timestamp = 0;
+  // full state rather than an incremental
+  bool snapshot     = false;
+  // kline only, seconds
+  int32_t interval  = 0;
+};
+
+// "type" of market data and aop messages, snapshot or incremental
+inline bool IsSnapshot(std::string_view message)
+{
+  std::string_view type;
+  return common::json::GetString(message, "type", type) && "snapshot" == type;
+}
+
+// Interval of the first row of a kline message, rows are
+// `[timestamp,interval,last_close,open,high,low,close,volume,turnover]`
+inline bool KlineInterval(std::string_view message, int32_t& interval)
+{
+  using namespace common::json;
+
+  const auto rows = FindValue(message, "kline");
+  if (0 != rows.rfind("[[", 0))
+  {
+    return false;
+  }
+  const auto comma = rows.find(',');
+  return std::string_view::npos != comma &&
+         AsInteger(rows.substr(comma + 1), interval);
+}
+
+// Decode the header of a market data or aop message without building a json
+// DOM, returns false for replies and other messages without sequence number.
+// Aop messages have no symbol, kline messages without rows no interval.
+inline bool PeekHeader(std::string_view message, MessageHeader& header)
+{
+  using namespace common::json;
+
+  header = MessageHeader{};
+  if (HasKey(message, "book"))
+  {
+    header.channel = Channel::kOrderBook;
+  }
+  else if (HasKey(message, "trades"))
+  {
+    header.channel = Channel::kTrade;
+  }
+  else if (HasKey(message, "kline"))
+  {
+    header.channel = Channel::kKline;
+    if (!KlineInterval(message, header.interval))
+    {
+      return false;
+    }
+  }
+  else if (IsAop(message))
+  {
+    header.channel = Channel::kAop;
+    GetInteger(message, "timestamp", header.timestamp);
+    header.snapshot = IsSnapshot(message);
+    return GetInteger(message, "sequence", header.sequence);
+  }
+  else
+  {
+    return false;
+  }
+
+  GetInteger(message, "timestamp", header.timestamp);
+  header.snapshot = IsSnapshot(message);
+  return GetString(message, "symbol", header.symbol) &&
+         GetInteger(message, "sequence", header.sequence);
+}
+
+} // namespace phemex
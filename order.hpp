@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace phemex
+{
+enum class Side
+{
+  kBuy,
+  kSell
+};
+
+inline std::string_view ToString(Side side)
+{
+  return Side::kBuy == side ? "Buy" : "Sell";
+}
+
+enum class OrderType
+{
+  kLimit,
+  kMarket
+};
+
+inline std::string_view ToString(OrderType type)
+{
+  return OrderType::kLimit == type ? "Limit" : "Market";
+}
+
+enum class TimeInForce
+{
+  kGoodTillCancel,
+  kPostOnly,
+  kImmediateOrCancel,
+  kFillOrKill
+};
+
+inline std::string_view ToString(TimeInForce time_in_force)
+{
+  switch (time_in_force)
+  {
+  case TimeInForce::kPostOnly:
+    return "PostOnly";
+  case TimeInForce::kImmediateOrCancel:
+    return "ImmediateOrCancel";
+  case TimeInForce::kFillOrKill:
+    return "FillOrKill";
+  default:
+    return "GoodTillCancel";
+  }
+}
+
+// New contract order, prices are scaled integers (Ep) of the symbol
+struct OrderRequest
+{
+  std::string symbol;
+  // client side id, echoed back in replies and order updates
+  std::string cl_ord_id;
+  Side side                 = Side::kBuy;
+  OrderType type            = OrderType::kLimit;
+  TimeInForce time_in_force = TimeInForce::kGoodTillCancel;
+  int64_t price_ep          = 0;
+  int64_t quantity          = 0;
+  bool reduce_only          = false;
+};
+
+// New price and quantity of a resting order, zero keeps the current value
+struct AmendRequest
+{
+  std::string symbol;
+  std::string order_id;
+  int64_t price_ep = 0;
+  int64_t quantity = 0;
+};
+
+} // namespace phemex
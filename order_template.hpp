@@ -0,0 +1,162 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "common/crypto/hmac_signer.hpp"
+#include "order.hpp"
+
+namespace phemex
+{
+// Complete place order request of one symbol, side and order type, headers
+// and body serialized once. Placing an order only patches clOrdID, priceEp,
+// orderQty, the expiry and the signature at their fixed offsets: numbers are
+// right aligned and the id left aligned in slots padded with blanks, which
+// json allows between tokens, so the content length never changes.
+class OrderTemplate
+{
+ public:
+  // longest client order id accepted by the exchange
+  static constexpr std::size_t kClOrdIdSize = 40;
+  static constexpr std::size_t kNumberSize =
+      std::numeric_limits<int64_t>::digits10 + 1;
+  // epoch seconds, ten digits until the year 2286
+  static constexpr std::size_t kExpirySize = 10;
+
+  OrderTemplate(
+      std::string_view host, std::string_view api_key,
+      const OrderRequest& order)
+  {
+    std::string body{R"({"actionBy":"FromOrderPlacement","symbol":")"};
+    body.append(order.symbol);
+    body.append(R"(","side":")");
+    body.append(ToString(order.side));
+    body.append(R"(","ordType":")");
+    body.append(ToString(order.type));
+    body.append(R"(","timeInForce":")");
+    body.append(ToString(order.time_in_force));
+    body.append(R"(","reduceOnly":)");
+    body.append(order.reduce_only ? "true" : "false");
+    body.append(R"(,"clOrdID":)");
+    cl_ord_id_ = Slot(body, kClOrdIdSize + 2);
+    body.append(R"(,"orderQty":)");
+    quantity_ = Slot(body, kNumberSize);
+    if (OrderType::kLimit == order.type)
+    {
+      body.append(R"(,"priceEp":)");
+      price_ep_ = Slot(body, kNumberSize);
+    }
+    body.push_back('}');
+
+    wire_.append("POST ").append(kPath).append(" HTTP/1.1\r\nHost: ");
+    wire_.append(host);
+    wire_.append("\r\nContent-Type: application/json\r\n");
+    wire_.append("x-phemex-access-token: ").append(api_key);
+    wire_.append("\r\nx-phemex-request-expiry: ");
+    expiry_ = Slot(wire_, kExpirySize);
+    wire_.append("\r\nx-phemex-request-signature: ");
+    signature_ = Slot(wire_, common::crypto::HmacSigner::kHexSize);
+    wire_.append("\r\nContent-Length: ").append(std::to_string(body.size()));
+    wire_.append("\r\n\r\n");
+
+    body_ = wire_.size();
+    cl_ord_id_ += body_;
+    quantity_ += body_;
+    price_ep_ += 0 == price_ep_ ? 0 : body_;
+    wire_.append(body);
+  }
+
+  // Patch the variable fields and sign the body. The view refers to the
+  // template and stays valid until the next Fill(). The price is ignored by
+  // market orders, the id should be printable ascii without quotes or
+  // backslashes, it is copied into the json unescaped.
+  inline std::string_view Fill(
+      std::string_view cl_ord_id, int64_t price_ep, int64_t quantity,
+      int64_t expiry, common::crypto::HmacSigner& signer)
+  {
+    if (cl_ord_id.size() > kClOrdIdSize)
+    {
+      throw std::invalid_argument{"client order id is too long"};
+    }
+    for (const auto c : cl_ord_id)
+    {
+      if (c < ' ' || c > '~' || '"' == c || '\\' == c)
+      {
+        throw std::invalid_argument{"client order id should be printable "
+                                    "ascii without quotes or backslashes"};
+      }
+    }
+    auto* id = &wire_[cl_ord_id_];
+    std::memset(id, ' ', kClOrdIdSize + 2);
+    id[0] = '"';
+    std::memcpy(id + 1, cl_ord_id.data(), cl_ord_id.size());
+    id[cl_ord_id.size() + 1] = '"';
+
+    PutNumber(quantity_, kNumberSize, quantity);
+    if (0 != price_ep_)
+    {
+      PutNumber(price_ep_, kNumberSize, price_ep);
+    }
+    PutNumber(expiry_, kExpirySize, expiry);
+
+    common::crypto::HmacSigner::Signature signature;
+    signer.Sign(
+        signature, kPath, std::string_view{&wire_[expiry_], kExpirySize},
+        Body());
+    std::memcpy(&wire_[signature_], signature.data(), signature.size());
+    return wire_;
+  }
+
+  inline std::string_view Body() const
+  {
+    return std::string_view{wire_}.substr(body_);
+  }
+
+  inline const std::string& Wire() const
+  {
+    return wire_;
+  }
+
+ private:
+  static constexpr std::string_view kPath{"/orders"};
+
+  // Reserve a blank slot at the end of text, returns its offset
+  static inline std::size_t Slot(std::string& text, std::size_t size)
+  {
+    const auto offset = text.size();
+    text.append(size, ' ');
+    return offset;
+  }
+
+  // Right aligned in its slot, negative or too wide values are rejected
+  inline void PutNumber(std::size_t offset, std::size_t size, int64_t value)
+  {
+    char digits[kNumberSize + 1];
+    const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    const auto length = static_cast<std::size_t>(end - digits);
+    if (value < 0 || length > size)
+    {
+      throw std::invalid_argument{"order field out of range"};
+    }
+    auto* slot = &wire_[offset];
+    std::memset(slot, ' ', size - length);
+    std::memcpy(slot + size - length, digits, length);
+  }
+
+ private:
+  std::string wire_;
+  std::size_t body_      = 0;
+  std::size_t expiry_    = 0;
+  std::size_t signature_ = 0;
+  std::size_t cl_ord_id_ = 0;
+  std::size_t quantity_  = 0;
+  // 0 for market orders
+  std::size_t price_ep_ = 0;
+};
+
+} // namespace phemex
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <charconv>
+#include <memory>
+#include <vector>
+
+#include "client.hpp"
+#include "common/config/redundant_client.hpp"
+#include "common/net/feed_arbiter.hpp"
+#include "message.hpp"
+
+namespace phemex
+{
+// Open the same subscriptions on several connections (hot-hot) and deliver
+// whichever copy of a sequenced message arrives first, later copies are
+// dropped. Replies and other unsequenced messages are delivered from every
+// feed. All feeds share the io_context thread of the arbiter.
+class RedundantClient
+{
+ public:
+  using FeedStats = common::net::FeedArbiter::FeedStats;
+
+  RedundantClient(
+      boost::asio::io_context& ioc,
+      const common::config::RedundantClient& conf,
+      std::function<void(std::string)> ws_msg_callback)
+    : arbiter_{conf.feeds, conf.reset_gap}, ws_msg_callback_{ws_msg_callback}
+  {
+    if (0 == conf.feeds)
+    {
+      throw std::invalid_argument{"feed count should be positive"};
+    }
+
+    for (uint32_t i = 0; i < conf.feeds; ++i)
+    {
+      auto websocket = conf.websocket;
+      if (!conf.endpoints.empty())
+      {
+        websocket.addr = conf.endpoints[i % conf.endpoints.size()];
+      }
+      feeds_.push_back(std::make_unique<Client>(
+          ioc, websocket, [this, i](std::string message) {
+            OnMessage(i, std::move(message));
+          }));
+    }
+  }
+
+  RedundantClient(const RedundantClient&) = delete;
+  RedundantClient& operator=(const RedundantClient&) = delete;
+
+  inline void SubscribeOrderBook(const std::string& symbol)
+  {
+    Reset(Channel::kOrderBook, symbol);
+    for (auto& feed : feeds_)
+    {
+      feed->SubscribeOrderBook(symbol);
+    }
+  }
+
+  inline void SubscribeKline(const std::string& symbol, int32_t interval)
+  {
+    Reset(Channel::kKline, symbol, interval);
+    for (auto& feed : feeds_)
+    {
+      feed->SubscribeKline(symbol, interval);
+    }
+  }
+
+  inline void SubscribeTrade(const std::string& symbol)
+  {
+    Reset(Channel::kTrade, symbol);
+    for (auto& feed : feeds_)
+    {
+      feed->SubscribeTrade(symbol);
+    }
+  }
+
+  inline void UnsubscribeOrderBook()
+  {
+    for (auto& feed : feeds_)
+    {
+      feed->UnsubscribeOrderBook();
+    }
+  }
+
+  inline void UnsubscribeKline()
+  {
+    for (auto& feed : feeds_)
+    {
+      feed->UnsubscribeKline();
+    }
+  }
+
+  inline void UnsubscribeTrade()
+  {
+    for (auto& feed : feeds_)
+    {
+      feed->UnsubscribeTrade();
+    }
+  }
+
+  inline void Stop()
+  {
+    for (auto& feed : feeds_)
+    {
+      feed->Stop();
+    }
+  }
+
+  inline auto Size() const
+  {
+    return feeds_.size();
+  }
+
+  inline auto& Feed(std::size_t index)
+  {
+    return *feeds_.at(index);
+  }
+
+  // win rate and delay behind the winning copy of one feed
+  inline const FeedStats& Stats(std::size_t index) const
+  {
+    return arbiter_.Stats(index);
+  }
+
+  inline void ResetStats()
+  {
+    arbiter_.ResetStats();
+  }
+
+  // Accept the next message of the stream whatever its sequence, a new
+  // subscription may start below the sequence of an earlier one. Interval
+  // of kline streams only.
+  inline void Reset(
+      Channel channel, std::string_view symbol, int32_t interval = 0)
+  {
+    arbiter_.Reset(Key(channel, symbol, interval));
+  }
+
+ private:
+  inline void OnMessage(std::size_t feed, std::string&& message)
+  {
+    MessageHeader header;
+    if (PeekHeader(message, header))
+    {
+      if (!arbiter_.Accept(
+              feed, Key(header.channel, header.symbol, header.interval),
+              header.sequence, header.snapshot))
+      {
+        return;
+      }
+    }
+    ws_msg_callback_(std::move(message));
+  }
+
+  // `<channel>.<symbol>`, `kline.<symbol>.<interval>`, built in place
+  inline const std::string& Key(
+      Channel channel, std::string_view symbol, int32_t interval)
+  {
+    key_.assign(ToString(channel)).append(1, '.').append(symbol);
+    if (Channel::kKline == channel)
+    {
+      char digits[16];
+      const auto end =
+          std::to_chars(digits, digits + sizeof(digits), interval).ptr;
+      key_.append(1, '.').append(digits, end);
+    }
+    return key_;
+  }
+
+ private:
+  common::net::FeedArbiter arbiter_;
+  std::string key_;
+  std::function<void(std::string)> ws_msg_callback_;
+  std::vector<std::unique_ptr<Client>> feeds_;
+};
+} // namespace phemex
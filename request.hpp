@@ -0,0 +1,123 @@
+#pragma once
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace phemex
+{
+// Serialize json-rpc requests `{"method":..,"params":[..],"id":..}` straight
+// into a reusable buffer, without building a json DOM
+class RequestWriter
+{
+ public:
+  RequestWriter()
+  {
+    buffer_.reserve(256);
+  }
+
+  inline RequestWriter& Begin(std::string_view method)
+  {
+    buffer_.assign("{\"method\":\"");
+    buffer_.append(method);
+    buffer_.append("\",\"params\":[");
+    first_ = true;
+    return *this;
+  }
+
+  inline RequestWriter& Param(std::string_view value)
+  {
+    Separate();
+    buffer_.push_back('"');
+    for (const auto c : value)
+    {
+      Escape(c);
+    }
+    buffer_.push_back('"');
+    return *this;
+  }
+
+  inline RequestWriter& Param(const std::string& value)
+  {
+    return Param(std::string_view{value});
+  }
+
+  inline RequestWriter& Param(const char* value)
+  {
+    return Param(std::string_view{value});
+  }
+
+  template <class T>
+  inline RequestWriter& Param(T value)
+  {
+    static_assert(std::is_integral<T>::value, "unsupported parameter type");
+    Separate();
+    AppendInteger(value);
+    return *this;
+  }
+
+  // Close the request, the view is valid until the next Begin()
+  inline std::string_view End(int64_t id)
+  {
+    buffer_.append("],\"id\":");
+    AppendInteger(id);
+    buffer_.push_back('}');
+    return buffer_;
+  }
+
+ private:
+  inline void Separate()
+  {
+    if (!first_)
+    {
+      buffer_.push_back(',');
+    }
+    first_ = false;
+  }
+
+  template <class T>
+  inline void AppendInteger(T value)
+  {
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer_.append(digits, result.ptr);
+  }
+
+  inline void Escape(char c)
+  {
+    static constexpr char kHex[] = "0123456789abcdef";
+    if ('"' == c || '\\' == c)
+    {
+      buffer_.push_back('\\');
+      buffer_.push_back(c);
+    }
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      buffer_.append("\\u00");
+      buffer_.push_back(kHex[(c >> 4) & 0x0f]);
+      buffer_.push_back(kHex[c & 0x0f]);
+    }
+    else
+    {
+      buffer_.push_back(c);
+    }
+  }
+
+ private:
+  std::string buffer_;
+  bool first_ = true;
+};
+
+// Constant requests, serialized once
+struct Frames
+{
+  static inline const std::string& Ping()
+  {
+    static const std::string frame{
+        RequestWriter{}.Begin("server.ping").End(0)};
+    return frame;
+  }
+};
+
+} // namespace phemex
@@ -0,0 +1,517 @@
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#include "common/chrono/histogram.hpp"
+#include "common/chrono/time.hpp"
+#include "common/config/rest_client.hpp"
+#include "common/crypto/hmac_signer.hpp"
+#include "common/json/scanner.hpp"
+#include "common/log.hpp"
+#include "common/net/tcp/http/client.hpp"
+#include "common/net/tcp/http/rate_limiter.hpp"
+#include "order.hpp"
+#include "order_template.hpp"
+
+namespace phemex
+{
+// Order entry endpoints of the contract api, latency is kept per endpoint
+enum class Endpoint
+{
+  kPlace,
+  kAmend,
+  kCancel,
+  kCancelAll,
+  kQueryOrder,
+  kActiveOrders
+};
+
+inline constexpr std::size_t kEndpoints =
+    static_cast<std::size_t>(Endpoint::kActiveOrders) + 1;
+
+inline std::string_view ToString(Endpoint endpoint)
+{
+  switch (endpoint)
+  {
+  case Endpoint::kPlace:
+    return "place";
+  case Endpoint::kAmend:
+    return "amend";
+  case Endpoint::kCancel:
+    return "cancel";
+  case Endpoint::kCancelAll:
+    return "cancel_all";
+  case Endpoint::kQueryOrder:
+    return "query_order";
+  default:
+    return "active_orders";
+  }
+}
+
+// Order requests may take the reserve of their rate limit group, queries
+// wait for the tokens above it
+inline common::net::tcp::http::RateLimiter::Priority PriorityOf(
+    Endpoint endpoint)
+{
+  using Priority = common::net::tcp::http::RateLimiter::Priority;
+  return Endpoint::kQueryOrder == endpoint ||
+                 Endpoint::kActiveOrders == endpoint
+             ? Priority::kLow
+             : Priority::kHigh;
+}
+
+// Rate limit group the endpoint counts against, all order entry endpoints
+// share the contract one
+inline std::string_view GroupOf(Endpoint)
+{
+  return "contract";
+}
+
+// Reply of a rest request, body is the raw `{"code":..,"msg":..,"data":..}`
+struct RestReply
+{
+  boost::system::error_code ec;
+  unsigned status = 0;
+  // business code of the body, -1 if none was received
+  int64_t code = -1;
+  std::string body;
+  std::chrono::nanoseconds rtt{0};
+
+  inline bool Ok() const
+  {
+    return !ec && 200 == status && 0 == code;
+  }
+};
+
+// Authenticated order entry over the keep-alive connections of an http
+// client. Requests are built and signed on the calling thread, so they should
+// come from one thread at a time, the callback runs on the strand of the
+// client.
+//
+// Requests take a token of their rate limit group on the strand before they
+// are sent. Queries short of tokens above the reserve wait for them in
+// order, or get try_again at once if the wait would be longer than
+// max_defer or too many are waiting. Order requests are never held back,
+// unless the server blocks the group, which they get try_again for.
+class RestClient
+{
+ public:
+  using Callback    = std::function<void(RestReply&&)>;
+  using verb        = boost::beast::http::verb;
+  using RateLimiter = common::net::tcp::http::RateLimiter;
+
+  RestClient(
+      boost::asio::io_context& ioc, const common::config::RestClient& conf,
+      std::shared_ptr<common::net::SSLContext> ssl_context =
+          common::net::SSLContext::Shared())
+    : http_{ioc, conf, true, std::move(ssl_context)},
+      api_key_{conf.api_key},
+      signer_{conf.api_secret},
+      expiry_{static_cast<int64_t>(conf.expiry)},
+      limiter_{conf.rate_limits},
+      deferred_size_{conf.deferred_size},
+      max_defer_{std::chrono::duration_cast<RateLimiter::Clock::duration>(
+          std::chrono::duration<double>{conf.max_defer})},
+      release_{ioc}
+  {
+    if (api_key_.empty() || conf.api_secret.empty())
+    {
+      throw std::invalid_argument{"rest client should have an api key"};
+    }
+    if (conf.max_defer >= conf.expiry)
+    {
+      throw std::invalid_argument{"requests would expire while deferred"};
+    }
+    for (std::size_t i = 0; i < kEndpoints; ++i)
+    {
+      groups_[i] = limiter_.Group(GroupOf(static_cast<Endpoint>(i)));
+    }
+  }
+
+  RestClient(const RestClient&) = delete;
+  RestClient& operator=(const RestClient&) = delete;
+
+  inline void Stop()
+  {
+    boost::asio::post(http_.Strand(), [this]() {
+      release_.cancel();
+      for (auto& deferred : deferred_)
+      {
+        Reject(deferred.callback, boost::asio::error::operation_aborted);
+      }
+      deferred_.clear();
+    });
+    http_.Stop();
+  }
+
+  // Place request of the order's symbol, side, type, time in force and
+  // reduce-only flag, serialized on first use. The http client sets the host
+  // of the address in use when it is sent. Build the ones on the hot path
+  // ahead of trading, the reference stays valid.
+  inline OrderTemplate& Template(const OrderRequest& order)
+  {
+    const auto key = std::make_tuple(
+        order.symbol, order.side, order.type, order.time_in_force,
+        order.reduce_only);
+    auto it = templates_.find(key);
+    if (templates_.end() == it)
+    {
+      it = templates_
+               .emplace(key, OrderTemplate{http_.Host(), api_key_, order})
+               .first;
+    }
+    return it->second;
+  }
+
+  inline void PlaceOrder(const OrderRequest& order, Callback callback)
+  {
+    PlaceOrder(
+        Template(order), order.cl_ord_id, order.price_ep, order.quantity,
+        std::move(callback));
+  }
+
+  // Patch the template of the order in place and send it, no json is built.
+  // The filled bytes are copied into one string for the send queue so the
+  // template can be reused at once, the only allocation per order on this
+  // thread; it is freed on the strand once sent.
+  inline void PlaceOrder(
+      OrderTemplate& order, std::string_view cl_ord_id, int64_t price_ep,
+      int64_t quantity, Callback callback)
+  {
+    const auto wire = order.Fill(
+        cl_ord_id, price_ep, quantity,
+        common::chrono::Time::Now<std::chrono::seconds>() + expiry_, signer_);
+    boost::asio::post(
+        http_.Strand(), [this, wire = std::string{wire},
+                         callback = std::move(callback)]() mutable {
+          if (!Admit(Endpoint::kPlace, RateLimiter::Clock::now()))
+          {
+            Reject(callback, boost::asio::error::try_again);
+            return;
+          }
+          http_.Send(
+              std::move(wire), OnReply(Endpoint::kPlace, std::move(callback)));
+        });
+  }
+
+  inline void AmendOrder(const AmendRequest& amend, Callback callback)
+  {
+    auto query = "symbol=" + amend.symbol + "&orderID=" + amend.order_id;
+    if (0 != amend.price_ep)
+    {
+      query += "&priceEp=" + std::to_string(amend.price_ep);
+    }
+    if (0 != amend.quantity)
+    {
+      query += "&orderQty=" + std::to_string(amend.quantity);
+    }
+    Send(
+        Endpoint::kAmend, verb::put, "/orders/replace", query, "",
+        std::move(callback));
+  }
+
+  inline void CancelOrder(
+      const std::string& symbol, const std::string& order_id,
+      Callback callback)
+  {
+    Send(
+        Endpoint::kCancel, verb::delete_, "/orders/cancel",
+        "orderID=" + order_id + "&symbol=" + symbol, "", std::move(callback));
+  }
+
+  // Cancel the active orders of the symbol, conditional ones stay
+  inline void CancelAllOrders(const std::string& symbol, Callback callback)
+  {
+    Send(
+        Endpoint::kCancelAll, verb::delete_, "/orders/all",
+        "symbol=" + symbol + "&untriggered=false", "", std::move(callback));
+  }
+
+  inline void QueryOrder(
+      const std::string& symbol, const std::string& order_id,
+      Callback callback)
+  {
+    Send(
+        Endpoint::kQueryOrder, verb::get, "/exchange/order",
+        "symbol=" + symbol + "&orderID=" + order_id, "", std::move(callback));
+  }
+
+  inline void QueryActiveOrders(const std::string& symbol, Callback callback)
+  {
+    Send(
+        Endpoint::kActiveOrders, verb::get, "/orders/activeList",
+        "symbol=" + symbol, "", std::move(callback));
+  }
+
+  // Round trip nanoseconds of the endpoint's requests, read on the thread of
+  // the client
+  inline const auto& Latency(Endpoint endpoint) const
+  {
+    return latency_[static_cast<std::size_t>(endpoint)];
+  }
+
+  // Budget of the endpoint's rate limit group, call it on the strand of the
+  // client, e.g. from a callback. All tokens if the group has no limit.
+  inline common::net::tcp::http::RateBudget Budget(Endpoint endpoint)
+  {
+    const auto group = groups_[static_cast<std::size_t>(endpoint)];
+    if (RateLimiter::npos == group)
+    {
+      return {};
+    }
+    return limiter_.Budget(group, RateLimiter::Clock::now());
+  }
+
+  // Queries waiting for tokens, read on the strand of the client
+  inline std::size_t Deferred() const
+  {
+    return deferred_.size();
+  }
+
+  inline const auto& Http() const
+  {
+    return http_;
+  }
+
+ private:
+  void Send(
+      Endpoint endpoint, verb method, std::string_view path,
+      const std::string& query, std::string body, Callback callback)
+  {
+    char expiry[24];
+    const auto expiry_end =
+        std::to_chars(
+            expiry, expiry + sizeof(expiry),
+            common::chrono::Time::Now<std::chrono::seconds>() + expiry_)
+            .ptr;
+    const std::string_view expiry_text{
+        expiry, static_cast<std::size_t>(expiry_end - expiry)};
+    common::crypto::HmacSigner::Signature signature;
+
+    std::string target{path};
+    if (!query.empty())
+    {
+      target.push_back('?');
+      target.append(query);
+    }
+
+    common::net::tcp::http::Request request{method, target, 11};
+    request.set("x-phemex-access-token", api_key_);
+    const auto signed_text =
+        signer_.Sign(signature, path, query, expiry_text, body);
+    request.set(
+        "x-phemex-request-expiry",
+        boost::beast::string_view{expiry_text.data(), expiry_text.size()});
+    request.set(
+        "x-phemex-request-signature",
+        boost::beast::string_view{signed_text.data(), signed_text.size()});
+    if (!body.empty())
+    {
+      request.set(boost::beast::http::field::content_type, "application/json");
+    }
+    request.keep_alive(true);
+    request.body() = std::move(body);
+    request.prepare_payload();
+
+    boost::asio::post(
+        http_.Strand(), [this, endpoint, request = std::move(request),
+                         callback = std::move(callback)]() mutable {
+          Submit(endpoint, std::move(request), std::move(callback));
+        });
+  }
+
+  // On the strand: send the request if its group has a token for it, else
+  // defer or reject it
+  void Submit(
+      Endpoint endpoint, common::net::tcp::http::Request&& request,
+      Callback callback)
+  {
+    const auto now = RateLimiter::Clock::now();
+    if (Admit(endpoint, now))
+    {
+      http_.Send(std::move(request), OnReply(endpoint, std::move(callback)));
+      return;
+    }
+
+    const auto group = groups_[static_cast<std::size_t>(endpoint)];
+    if (RateLimiter::Priority::kHigh == PriorityOf(endpoint) ||
+        deferred_.size() >= deferred_size_ ||
+        limiter_.Available(group, Waiting(group), now) - now > max_defer_)
+    {
+      BOOST_LOG_SEV(client_lg, warning)
+          << "rest " << ToString(endpoint) << " rejected, rate limit group "
+          << GroupOf(endpoint) << " is out of tokens, "
+          << deferred_.size() << " deferred";
+      Reject(callback, boost::asio::error::try_again);
+      return;
+    }
+    deferred_.push_back(
+        {endpoint, group, now + max_defer_, std::move(request),
+         std::move(callback)});
+    ArmRelease(now);
+  }
+
+  // Take a token of the endpoint's group, queries only behind the ones
+  // already waiting
+  inline bool Admit(Endpoint endpoint, RateLimiter::TimePoint now)
+  {
+    const auto group    = groups_[static_cast<std::size_t>(endpoint)];
+    const auto priority = PriorityOf(endpoint);
+    if (RateLimiter::npos == group)
+    {
+      return true;
+    }
+    if (RateLimiter::Priority::kLow == priority && 0 != Waiting(group))
+    {
+      return false;
+    }
+    return limiter_.TryAcquire(group, priority, now);
+  }
+
+  inline std::size_t Waiting(std::size_t group) const
+  {
+    return static_cast<std::size_t>(std::count_if(
+        deferred_.begin(), deferred_.end(),
+        [group](const auto& deferred) { return group == deferred.group; }));
+  }
+
+  // Wake up when the first deferred query could take a token or is due
+  void ArmRelease(RateLimiter::TimePoint now)
+  {
+    auto release = RateLimiter::TimePoint::max();
+    for (const auto& deferred : deferred_)
+    {
+      release = std::min(
+          {release, deferred.deadline,
+           limiter_.Available(deferred.group, 0, now)});
+    }
+    release_.expires_at(release);
+    release_.async_wait(boost::asio::bind_executor(
+        http_.Strand(), [this](const boost::system::error_code& ec) {
+          if (!ec)
+          {
+            Release();
+          }
+        }));
+  }
+
+  // Send the deferred queries there are tokens for, in order per group. The
+  // ones still waiting at their deadline, e.g. once the server blocked the
+  // group, get try_again.
+  void Release()
+  {
+    const auto now = RateLimiter::Clock::now();
+    for (auto it = deferred_.begin(); it != deferred_.end();)
+    {
+      if (limiter_.TryAcquire(it->group, RateLimiter::Priority::kLow, now))
+      {
+        http_.Send(
+            std::move(it->request),
+            OnReply(it->endpoint, std::move(it->callback)));
+      }
+      else if (now >= it->deadline)
+      {
+        BOOST_LOG_SEV(client_lg, warning)
+            << "rest " << ToString(it->endpoint)
+            << " rejected, no token of rate limit group "
+            << GroupOf(it->endpoint) << " in time";
+        Reject(it->callback, boost::asio::error::try_again);
+      }
+      else
+      {
+        ++it;
+        continue;
+      }
+      it = deferred_.erase(it);
+    }
+    if (!deferred_.empty())
+    {
+      ArmRelease(now);
+    }
+  }
+
+  static inline void Reject(
+      const Callback& callback, const boost::system::error_code& ec)
+  {
+    RestReply reply;
+    reply.ec = ec;
+    callback(std::move(reply));
+  }
+
+  // Turn the http result into the reply handed to the callback
+  inline common::net::tcp::http::Client::Handler OnReply(
+      Endpoint endpoint, Callback callback)
+  {
+    return [this, endpoint, callback = std::move(callback)](
+               common::net::tcp::http::Result&& result) {
+      const auto group = groups_[static_cast<std::size_t>(endpoint)];
+      if (!result.ec && RateLimiter::npos != group)
+      {
+        limiter_.Update(group, result.response, RateLimiter::Clock::now());
+      }
+
+      RestReply reply;
+      reply.ec     = result.ec;
+      reply.status = result.response.result_int();
+      reply.body   = std::move(result.response.body());
+      reply.rtt    = result.rtt;
+      common::json::GetInteger(reply.body, "code", reply.code);
+      if (!reply.ec)
+      {
+        latency_[static_cast<std::size_t>(endpoint)].Record(
+            reply.rtt.count());
+      }
+      if (!reply.Ok())
+      {
+        BOOST_LOG_SEV(client_lg, warning)
+            << "rest " << ToString(endpoint) << " failed, status "
+            << reply.status << ", error: " << reply.ec.message()
+            << ", body: " << reply.body;
+      }
+      callback(std::move(reply));
+    };
+  }
+
+ private:
+  common::net::tcp::http::Client http_;
+  std::string api_key_;
+  // hmac-sha256 of path + query + expiry + body
+  common::crypto::HmacSigner signer_;
+  int64_t expiry_;
+  std::array<common::chrono::Histogram, kEndpoints> latency_;
+  // symbol, side, type, time in force and reduce-only flag
+  std::map<
+      std::tuple<std::string, Side, OrderType, TimeInForce, bool>,
+      OrderTemplate>
+      templates_;
+
+  // A query waiting for a token of its group
+  struct Pending
+  {
+    Endpoint endpoint;
+    std::size_t group;
+    // rejected if still waiting then
+    RateLimiter::TimePoint deadline;
+    common::net::tcp::http::Request request;
+    Callback callback;
+  };
+
+  RateLimiter limiter_;
+  // rate limit group of every endpoint, npos if not limited
+  std::array<std::size_t, kEndpoints> groups_;
+  std::deque<Pending> deferred_;
+  std::size_t deferred_size_;
+  RateLimiter::Clock::duration max_defer_;
+  boost::asio::steady_timer release_;
+};
+
+} // namespace phemex
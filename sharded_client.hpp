@@ -0,0 +1,247 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "client.hpp"
+#include "common/config/sharded_client.hpp"
+#include "common/net/io_context_pool.hpp"
+#include "common/net/shard_policy.hpp"
+
+namespace phemex
+{
+// Spread symbol subscriptions over several websocket connections. All
+// subscriptions of one symbol stay on the same shard, every shard reconnects
+// on its own and all messages are merged into one callback. Shards created on
+// an IOContextPool run on their own threads, the callback is then invoked
+// concurrently from those threads.
+template <class ShardPolicy = common::net::HashShardPolicy>
+class ShardedClient : public ShardPolicy
+{
+ public:
+  class Shard
+  {
+   public:
+    Shard(
+        boost::asio::io_context& ioc,
+        const common::config::WebsocketClient& conf,
+        const std::function<void(std::string)>& ws_msg_callback)
+      : ioc_{ioc},
+        messages_{0},
+        rate_{0},
+        client_{ioc, conf, [this, ws_msg_callback](std::string message) {
+                  messages_.fetch_add(1, std::memory_order_relaxed);
+                  ws_msg_callback(std::move(message));
+                }}
+    {
+    }
+
+    inline auto& Session()
+    {
+      return client_;
+    }
+
+    // Run the handler on the thread of the shard
+    template <class F>
+    inline void Post(F&& handler)
+    {
+      boost::asio::post(ioc_, std::forward<F>(handler));
+    }
+
+    inline auto Symbols() const
+    {
+      return symbols_;
+    }
+
+    inline void AddSymbol()
+    {
+      ++symbols_;
+    }
+
+    inline auto Messages() const
+    {
+      return messages_.load(std::memory_order_relaxed);
+    }
+
+    // messages per second, smoothed
+    inline auto MessageRate() const
+    {
+      return rate_.load(std::memory_order_relaxed);
+    }
+
+    inline void SampleRate(double smoothing)
+    {
+      const auto messages = Messages();
+      rate_.store(
+          smoothing * (messages - last_messages_) +
+              (1 - smoothing) * MessageRate(),
+          std::memory_order_relaxed);
+      last_messages_ = messages;
+    }
+
+   private:
+    boost::asio::io_context& ioc_;
+    std::atomic<uint64_t> messages_;
+    std::atomic<double> rate_;
+    Client client_;
+    std::size_t symbols_    = 0;
+    uint64_t last_messages_ = 0;
+  };
+
+  ShardedClient(
+      boost::asio::io_context& ioc, const common::config::ShardedClient& conf,
+      std::function<void(std::string)> ws_msg_callback)
+    : ShardedClient{ioc, conf, ws_msg_callback,
+                    [&ioc]() -> boost::asio::io_context& { return ioc; }}
+  {
+  }
+
+  // Spread the shards over the threads of the pool
+  ShardedClient(
+      common::net::IOContextPool& pool,
+      const common::config::ShardedClient& conf,
+      std::function<void(std::string)> ws_msg_callback)
+    : ShardedClient{pool.At(0), conf, ws_msg_callback,
+                    [&pool]() -> boost::asio::io_context& {
+                      return pool.Next();
+                    }}
+  {
+  }
+
+  ShardedClient(const ShardedClient&) = delete;
+  ShardedClient& operator=(const ShardedClient&) = delete;
+
+  inline void SubscribeOrderBook(const std::string& symbol)
+  {
+    auto& shard = Route(symbol);
+    shard.Post(
+        [&shard, symbol]() { shard.Session().SubscribeOrderBook(symbol); });
+  }
+
+  inline void SubscribeKline(const std::string& symbol, int32_t interval)
+  {
+    auto& shard = Route(symbol);
+    shard.Post([&shard, symbol, interval]() {
+      shard.Session().SubscribeKline(symbol, interval);
+    });
+  }
+
+  inline void SubscribeTrade(const std::string& symbol)
+  {
+    auto& shard = Route(symbol);
+    shard.Post([&shard, symbol]() { shard.Session().SubscribeTrade(symbol); });
+  }
+
+  inline void UnsubscribeOrderBook()
+  {
+    for (auto& shard : shards_)
+    {
+      shard->Post([&shard]() { shard->Session().UnsubscribeOrderBook(); });
+    }
+  }
+
+  inline void UnsubscribeKline()
+  {
+    for (auto& shard : shards_)
+    {
+      shard->Post([&shard]() { shard->Session().UnsubscribeKline(); });
+    }
+  }
+
+  inline void UnsubscribeTrade()
+  {
+    for (auto& shard : shards_)
+    {
+      shard->Post([&shard]() { shard->Session().UnsubscribeTrade(); });
+    }
+  }
+
+  // Stop the shards and the rate sampling, callable from any thread
+  inline void Stop()
+  {
+    // on the timer's strand, a sample in flight would re-arm it
+    boost::asio::post(rate_strand_, [this]() { rate_timer_.Stop(); });
+    for (auto& shard : shards_)
+    {
+      shard->Post([&shard]() { shard->Session().Stop(); });
+    }
+  }
+
+  inline auto Size() const
+  {
+    return shards_.size();
+  }
+
+  inline auto& At(std::size_t index)
+  {
+    return *shards_.at(index);
+  }
+
+  // index of the shard serving the symbol, Size() if not subscribed
+  inline std::size_t ShardOf(const std::string& symbol) const
+  {
+    const auto it = symbol_shards_.find(symbol);
+    if (symbol_shards_.end() == it)
+    {
+      return shards_.size();
+    }
+    return it->second;
+  }
+
+ private:
+  template <class F>
+  ShardedClient(
+      boost::asio::io_context& ioc, const common::config::ShardedClient& conf,
+      const std::function<void(std::string)>& ws_msg_callback,
+      F&& next_context)
+    : conf_{conf}, rate_strand_{ioc}, rate_timer_{rate_strand_, 1}
+  {
+    if (0 == conf_.shards)
+    {
+      throw std::invalid_argument{"shard count should be positive"};
+    }
+
+    for (uint32_t i = 0; i < conf_.shards; ++i)
+    {
+      shards_.push_back(std::make_unique<Shard>(
+          next_context(), conf_.websocket, ws_msg_callback));
+    }
+    rate_timer_.Start([this]() { SampleRates(); });
+  }
+
+  // Shard of the symbol, a new symbol is assigned by the shard policy
+  inline Shard& Route(const std::string& symbol)
+  {
+    auto it = symbol_shards_.find(symbol);
+    if (symbol_shards_.end() == it)
+    {
+      const auto index = ShardPolicy::Select(symbol, shards_);
+      it               = symbol_shards_.emplace(symbol, index).first;
+      shards_[index]->AddSymbol();
+      BOOST_LOG(client_lg) << "assign symbol " << symbol << " to shard "
+                           << index;
+    }
+    return *shards_[it->second];
+  }
+
+  inline void SampleRates()
+  {
+    for (auto& shard : shards_)
+    {
+      shard->SampleRate(conf_.rate_smoothing);
+    }
+  }
+
+ private:
+  common::config::ShardedClient conf_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::unordered_map<std::string, std::size_t> symbol_shards_;
+  boost::asio::io_context::strand rate_strand_;
+  // fires on rate_strand_
+  common::DurationTimer<std::chrono::seconds, boost::asio::io_context::strand>
+      rate_timer_;
+};
+} // namespace phemex
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "common/json/scanner.hpp"
+#include "message.hpp"
+#include "request.hpp"
+
+namespace phemex
+{
+enum class SubscriptionState
+{
+  // requested, no reply yet, or waiting to be replayed after a reconnect
+  kPending,
+  kActive,
+  // rejected by the server, not replayed
+  kFailed,
+  kRemoved
+};
+
+inline std::string_view ToString(SubscriptionState state)
+{
+  switch (state)
+  {
+  case SubscriptionState::kPending:
+    return "pending";
+  case SubscriptionState::kActive:
+    return "active";
+  case SubscriptionState::kFailed:
+    return "failed";
+  default:
+    return "removed";
+  }
+}
+
+struct Subscription
+{
+  Channel channel = Channel::kUnknown;
+  std::string symbol;
+  // kline only
+  int32_t interval        = 0;
+  SubscriptionState state = SubscriptionState::kPending;
+  // id of the last request sent for it, 0 before the first
+  int64_t id = 0;
+};
+
+// Wanted subscriptions of one connection and the requests in flight. Every
+// request gets a new id and its reply moves the subscription along. After
+// a reconnect only the wanted set (active or pending) is requested again,
+// unsubscribes are sent once and never replayed. No IO, the owner sends the
+// requests Next() hands out.
+class SubscriptionManager
+{
+ public:
+  inline void Subscribe(
+      Channel channel, const std::string& symbol, int32_t interval = 0)
+  {
+    auto* sub = Find(channel, symbol, interval);
+    if (!sub)
+    {
+      subs_.push_back({channel, symbol, interval});
+      sub = &subs_.back();
+    }
+    else if (
+        SubscriptionState::kActive == sub->state ||
+        SubscriptionState::kPending == sub->state)
+    {
+      return;
+    }
+    sub->state = SubscriptionState::kPending;
+    sub->id    = 0;
+    queue_.push_back({Kind::kSubscribe, Index(*sub)});
+  }
+
+  // Drop every subscription of the channel, the server side unsubscribes
+  // all symbols of a channel at once
+  inline void Unsubscribe(Channel channel)
+  {
+    for (auto& sub : subs_)
+    {
+      if (channel == sub.channel)
+      {
+        sub.state = SubscriptionState::kRemoved;
+      }
+    }
+    queue_.push_back({Kind::kUnsubscribe, 0, channel});
+  }
+
+  // A new connection has no subscriptions: forget the replies still due and
+  // queue the wanted set
+  inline void Reset()
+  {
+    queue_.clear();
+    requests_.clear();
+    for (auto& sub : subs_)
+    {
+      if (SubscriptionState::kActive == sub.state ||
+          SubscriptionState::kPending == sub.state)
+      {
+        sub.state = SubscriptionState::kPending;
+        sub.id    = 0;
+        queue_.push_back({Kind::kSubscribe, Index(sub)});
+      }
+    }
+  }
+
+  // Requests queued other than those of the held channel
+  inline bool HasNext(Channel held = Channel::kUnknown) const
+  {
+    for (const auto& queued : queue_)
+    {
+      if (held != ChannelOf(queued))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Serialize the next queued request, the view is valid until the next
+  // call. Requests of the held channel stay queued in their order. Empty if
+  // nothing else is queued.
+  inline std::string_view Next(Channel held = Channel::kUnknown)
+  {
+    auto it = queue_.begin();
+    while (queue_.end() != it)
+    {
+      if (held == ChannelOf(*it))
+      {
+        ++it;
+        continue;
+      }
+      const auto queued = *it;
+      it                = queue_.erase(it);
+
+      const auto id = next_id_++;
+      if (Kind::kUnsubscribe == queued.kind)
+      {
+        requests_[id] = queued;
+        return writer_.Begin(Method(queued.channel, queued.kind)).End(id);
+      }
+
+      auto& sub = subs_[queued.index];
+      // removed or requested again since it was queued
+      if (SubscriptionState::kPending != sub.state || 0 != sub.id)
+      {
+        continue;
+      }
+      sub.id        = id;
+      requests_[id] = queued;
+      writer_.Begin(Method(sub.channel, queued.kind));
+      if (Channel::kAop != sub.channel)
+      {
+        writer_.Param(sub.symbol);
+      }
+      if (Channel::kKline == sub.channel)
+      {
+        writer_.Param(sub.interval);
+      }
+      return writer_.End(id);
+    }
+    return {};
+  }
+
+  // Match a reply `{"error":..,"id":..,"result":..}` to its request, false
+  // if the message is not a reply this manager waits for
+  inline bool OnReply(std::string_view message)
+  {
+    using namespace common::json;
+
+    int64_t id = 0;
+    if (requests_.empty() || !IsReply(message) ||
+        !GetInteger(message, "id", id))
+    {
+      return false;
+    }
+    const auto it = requests_.find(id);
+    if (requests_.end() == it)
+    {
+      return false;
+    }
+
+    const auto queued = it->second;
+    requests_.erase(it);
+    if (Kind::kSubscribe != queued.kind)
+    {
+      return true;
+    }
+
+    auto& sub = subs_[queued.index];
+    if (id == sub.id && SubscriptionState::kPending == sub.state)
+    {
+      const auto error = FindValue(message, "error");
+      sub.state        = 0 == error.rfind("null", 0)
+                             ? SubscriptionState::kActive
+                             : SubscriptionState::kFailed;
+    }
+    return true;
+  }
+
+  inline const auto& Subscriptions() const
+  {
+    return subs_;
+  }
+
+  // Id for a request the owner matches itself, e.g. user.auth
+  inline int64_t ReserveId()
+  {
+    return next_id_++;
+  }
+
+  // requests sent and not replied yet
+  inline std::size_t InFlight() const
+  {
+    return requests_.size();
+  }
+
+ private:
+  enum class Kind
+  {
+    kSubscribe,
+    kUnsubscribe
+  };
+
+  struct Queued
+  {
+    Kind kind;
+    // into subs_, subscribe only
+    std::size_t index;
+    // unsubscribe only
+    Channel channel = Channel::kUnknown;
+  };
+
+  inline Channel ChannelOf(const Queued& queued) const
+  {
+    return Kind::kUnsubscribe == queued.kind ? queued.channel
+                                             : subs_[queued.index].channel;
+  }
+
+  static inline std::string_view Method(Channel channel, Kind kind)
+  {
+    const bool subscribe = Kind::kSubscribe == kind;
+    switch (channel)
+    {
+    case Channel::kOrderBook:
+      return subscribe ? "orderbook.subscribe" : "orderbook.unsubscribe";
+    case Channel::kTrade:
+      return subscribe ? "trade.subscribe" : "trade.unsubscribe";
+    case Channel::kKline:
+      return subscribe ? "kline.subscribe" : "kline.unsubscribe";
+    case Channel::kAop:
+      return subscribe ? "aop.subscribe" : "aop.unsubscribe";
+    default:
+      return {};
+    }
+  }
+
+  inline Subscription* Find(
+      Channel channel, const std::string& symbol, int32_t interval)
+  {
+    for (auto& sub : subs_)
+    {
+      if (channel == sub.channel && symbol == sub.symbol &&
+          interval == sub.interval)
+      {
+        return &sub;
+      }
+    }
+    return nullptr;
+  }
+
+  inline std::size_t Index(const Subscription& sub) const
+  {
+    return static_cast<std::size_t>(&sub - subs_.data());
+  }
+
+ private:
+  std::vector<Subscription> subs_;
+  std::deque<Queued> queue_;
+  std::unordered_map<int64_t, Queued> requests_;
+  RequestWriter writer_;
+  // 0 is left to server.ping
+  int64_t next_id_ = 1;
+};
+
+} // namespace phemex
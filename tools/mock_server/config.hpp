@@ -0,0 +1,50 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include "common/config/utils.hpp"
+
+namespace phemex::mock
+{
+struct Config
+{
+  std::string address = "127.0.0.1";
+  uint16_t port       = 8443;
+  // io threads serving the sessions
+  uint32_t threads = 1;
+  // messages per second per session, 0 sends as fast as the socket drains
+  double rate = 1000;
+  // most frames packed into one tls write
+  uint32_t batch = 64;
+  // file with one message per line played instead of synthetic data
+  std::string replay;
+  // close a session abruptly after this many messages, 0 never
+  uint64_t disconnect_after = 0;
+  // skip one sequence number every this many messages, 0 never
+  uint64_t gap_every = 0;
+  // verify signed rest requests with this secret, empty accepts any
+  std::string api_secret;
+  // signed rest requests per minute before 429, 0 never limits
+  uint32_t rate_limit = 0;
+
+  inline auto ToString(int32_t indent_chars = 0) const
+  {
+    using namespace common::config;
+    std::ostringstream oss;
+    PutHeader(oss, indent_chars, "mock server");
+    PutLine(oss, indent_chars, "address", address, ":", port);
+    PutLine(oss, indent_chars, "threads", threads);
+    PutLine(oss, indent_chars, "rate", rate);
+    PutLine(oss, indent_chars, "batch", batch);
+    PutLine(oss, indent_chars, "replay", replay);
+    PutLine(oss, indent_chars, "disconnect_after", disconnect_after);
+    PutLine(oss, indent_chars, "gap_every", gap_every);
+    PutLine(
+        oss, indent_chars, "verify signatures", !api_secret.empty());
+    PutLine(oss, indent_chars, "rate_limit", rate_limit);
+    return oss.str();
+  }
+};
+
+} // namespace phemex::mock
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace phemex::mock
+{
+// Minimal websocket framing (RFC 6455) of the server side, so many frames can
+// be packed into one write
+enum Opcode : uint8_t
+{
+  kContinuation = 0x0,
+  kText         = 0x1,
+  kBinary       = 0x2,
+  kClose        = 0x8,
+  kPing         = 0x9,
+  kPong         = 0xa
+};
+
+// Append an unmasked final frame
+inline void AppendFrame(std::string& out, Opcode opcode, std::string_view data)
+{
+  out.push_back(static_cast<char>(0x80 | opcode));
+  const auto size = data.size();
+  if (size < 126)
+  {
+    out.push_back(static_cast<char>(size));
+  }
+  else if (size <= 0xffff)
+  {
+    out.push_back(static_cast<char>(126));
+    out.push_back(static_cast<char>(size >> 8));
+    out.push_back(static_cast<char>(size));
+  }
+  else
+  {
+    out.push_back(static_cast<char>(127));
+    for (int shift = 56; shift >= 0; shift -= 8)
+    {
+      out.push_back(static_cast<char>(static_cast<uint64_t>(size) >> shift));
+    }
+  }
+  out.append(data);
+}
+
+struct Frame
+{
+  Opcode opcode = kContinuation;
+  bool fin      = false;
+  std::string payload;
+};
+
+// Decode the frame at the front of data, returns the bytes it takes or 0 if
+// incomplete. Client frames are masked.
+inline std::size_t ParseFrame(std::string_view data, Frame& frame)
+{
+  if (data.size() < 2)
+  {
+    return 0;
+  }
+
+  const auto first  = static_cast<uint8_t>(data[0]);
+  const auto second = static_cast<uint8_t>(data[1]);
+  const auto masked = 0 != (second & 0x80);
+  uint64_t size     = second & 0x7f;
+  std::size_t pos   = 2;
+  if (126 == size || 127 == size)
+  {
+    const std::size_t bytes = 126 == size ? 2 : 8;
+    if (data.size() < pos + bytes)
+    {
+      return 0;
+    }
+    size = 0;
+    for (std::size_t i = 0; i < bytes; ++i)
+    {
+      size = (size << 8) | static_cast<uint8_t>(data[pos++]);
+    }
+  }
+
+  char mask[4] = {};
+  if (masked)
+  {
+    if (data.size() < pos + 4)
+    {
+      return 0;
+    }
+    data.copy(mask, 4, pos);
+    pos += 4;
+  }
+  if (data.size() - pos < size)
+  {
+    return 0;
+  }
+
+  frame.fin    = 0 != (first & 0x80);
+  frame.opcode = static_cast<Opcode>(first & 0x0f);
+  frame.payload.assign(data.substr(pos, size));
+  if (masked)
+  {
+    for (std::size_t i = 0; i < frame.payload.size(); ++i)
+    {
+      frame.payload[i] ^= mask[i % 4];
+    }
+  }
+  return pos + size;
+}
+
+} // namespace phemex::mock
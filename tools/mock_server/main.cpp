@@ -0,0 +1,82 @@
+// Local stand-in of the phemex public websocket api for benchmarks and
+// failure drills: answers server.ping and the subscribe requests, then streams
+// synthetic or recorded market data at a fixed rate. Plain https requests go
+// to a mock of the order entry rest api.
+//
+// usage: mock-server [--port 8443] [--rate 1000] [--replay file] ...
+
+#include <csignal>
+#include <iostream>
+
+#include <boost/asio/signal_set.hpp>
+#include <boost/program_options.hpp>
+
+#include "common/config/log.hpp"
+#include "common/log.hpp"
+#include "tools/mock_server/server.hpp"
+
+int main(int argc, char** argv)
+{
+  namespace po = boost::program_options;
+
+  phemex::mock::Config conf;
+  po::options_description options{"mock server options"};
+  options.add_options()("help,h", "print this message")(
+      "address", po::value(&conf.address)->default_value(conf.address),
+      "listen address")(
+      "port", po::value(&conf.port)->default_value(conf.port),
+      "listen port, 0 picks one")(
+      "threads", po::value(&conf.threads)->default_value(conf.threads),
+      "io threads")(
+      "rate", po::value(&conf.rate)->default_value(conf.rate),
+      "messages per second per session, 0 as fast as possible")(
+      "batch", po::value(&conf.batch)->default_value(conf.batch),
+      "most frames per tls write")(
+      "replay", po::value(&conf.replay),
+      "file of recorded messages, one per line")(
+      "disconnect-after",
+      po::value(&conf.disconnect_after)->default_value(conf.disconnect_after),
+      "drop a session after this many messages, 0 never")(
+      "gap-every", po::value(&conf.gap_every)->default_value(conf.gap_every),
+      "skip a sequence number every this many messages, 0 never")(
+      "api-secret", po::value(&conf.api_secret),
+      "verify signed rest requests with this secret")(
+      "rate-limit", po::value(&conf.rate_limit)->default_value(conf.rate_limit),
+      "signed rest requests per minute before 429, 0 never limits");
+
+  try
+  {
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, options), vm);
+    if (vm.count("help"))
+    {
+      std::cout << options << std::endl;
+      return 0;
+    }
+    po::notify(vm);
+
+    auto& logger =
+        phemex::common::Log::Get(phemex::common::config::Log{}, argv[0]);
+    BOOST_LOG(client_lg) << conf.ToString();
+
+    phemex::mock::Server server{conf};
+    server.Run();
+
+    // serve until interrupted
+    boost::asio::io_context ioc{1};
+    boost::asio::signal_set signals{ioc, SIGINT, SIGTERM};
+    signals.async_wait([&ioc](const auto&, int) { ioc.stop(); });
+    ioc.run();
+
+    server.Stop();
+    logger.Flush();
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "Error: failed to run mock server, reason: " << e.what()
+              << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "message.hpp"
+#include "tools/mock_server/frame.hpp"
+
+namespace phemex::mock
+{
+struct Subscription
+{
+  Channel channel = Channel::kUnknown;
+  std::string symbol;
+  int32_t interval = 60;
+  int64_t sequence = 0;
+};
+
+// Market data frames of the subscribed streams, taken round-robin. Synthetic
+// messages follow a random walk of the price, recorded messages are played in
+// order and looped.
+class MarketData
+{
+ public:
+  explicit MarketData(const std::vector<std::string>& replay)
+    : replay_{replay}
+  {
+    scratch_.reserve(512);
+  }
+
+  inline void Subscribe(
+      Channel channel, const std::string& symbol, int32_t interval)
+  {
+    for (const auto& sub : subs_)
+    {
+      if (sub.channel == channel && sub.symbol == symbol &&
+          (Channel::kKline != channel || sub.interval == interval))
+      {
+        return;
+      }
+    }
+    subs_.push_back({channel, symbol, interval, 0});
+  }
+
+  // Drop every subscription of the channel
+  inline void Unsubscribe(Channel channel)
+  {
+    std::vector<Subscription> kept;
+    for (auto& sub : subs_)
+    {
+      if (sub.channel != channel)
+      {
+        kept.push_back(std::move(sub));
+      }
+    }
+    subs_.swap(kept);
+  }
+
+  inline bool Empty() const
+  {
+    return subs_.empty();
+  }
+
+  // Append the next message as a frame, skipping one sequence number (or
+  // recorded message) first if gap is set
+  inline void Next(std::string& out, int64_t now, bool gap)
+  {
+    if (!replay_.empty())
+    {
+      replay_pos_ += gap ? 2 : 1;
+      AppendFrame(out, kText, replay_[(replay_pos_ - 1) % replay_.size()]);
+      return;
+    }
+
+    auto& sub = subs_[next_++ % subs_.size()];
+    sub.sequence += gap ? 2 : 1;
+    Walk();
+
+    scratch_.clear();
+    switch (sub.channel)
+    {
+    case Channel::kOrderBook:
+      Book(sub, now);
+      break;
+    case Channel::kTrade:
+      Trade(sub, now);
+      break;
+    default:
+      Kline(sub, now);
+      break;
+    }
+    AppendFrame(out, kText, scratch_);
+  }
+
+ private:
+  // {"book":{"asks":[[p,q]],"bids":[[p,q]]},"depth":30,"sequence":..,
+  //  "symbol":..,"timestamp":..,"type":"snapshot"|"incremental"}
+  inline void Book(const Subscription& sub, int64_t now)
+  {
+    Append("{\"book\":{\"asks\":[[");
+    Append(price_ + 5000);
+    Append(",");
+    Append(Size());
+    Append("]],\"bids\":[[");
+    Append(price_);
+    Append(",");
+    Append(Size());
+    Append("]]},\"depth\":30,\"sequence\":");
+    Append(sub.sequence);
+    Append(",\"symbol\":\"");
+    Append(sub.symbol);
+    Append("\",\"timestamp\":");
+    Append(now);
+    Append(1 == sub.sequence ? ",\"type\":\"snapshot\"}"
+                             : ",\"type\":\"incremental\"}");
+  }
+
+  // {"sequence":..,"symbol":..,"trades":[[ts,"Buy",p,q]],"type":..}
+  inline void Trade(const Subscription& sub, int64_t now)
+  {
+    Append("{\"sequence\":");
+    Append(sub.sequence);
+    Append(",\"symbol\":\"");
+    Append(sub.symbol);
+    Append("\",\"timestamp\":");
+    Append(now);
+    Append(",\"trades\":[[");
+    Append(now);
+    Append(rng_ & 1 ? ",\"Buy\"," : ",\"Sell\",");
+    Append(price_);
+    Append(",");
+    Append(Size());
+    Append("]],\"type\":\"incremental\"}");
+  }
+
+  // {"kline":[[ts,interval,last_close,open,high,low,close,volume,turnover]],
+  //  "sequence":..,"symbol":..,"type":..}
+  inline void Kline(const Subscription& sub, int64_t now)
+  {
+    const auto seconds = now / 1000000000;
+    Append("{\"kline\":[[");
+    Append(seconds - seconds % sub.interval);
+    Append(",");
+    Append(int64_t{sub.interval});
+    for (const auto price : {price_, price_, price_ + 5000, price_ - 5000})
+    {
+      Append(",");
+      Append(price);
+    }
+    Append(",");
+    Append(price_);
+    Append(",");
+    Append(Size());
+    Append(",");
+    Append(Size() * 8770);
+    Append("]],\"sequence\":");
+    Append(sub.sequence);
+    Append(",\"symbol\":\"");
+    Append(sub.symbol);
+    Append("\",\"type\":\"incremental\"}");
+  }
+
+  // xorshift step moving the price by at most one tick either way
+  inline void Walk()
+  {
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 7;
+    rng_ ^= rng_ << 17;
+    price_ += static_cast<int64_t>(rng_ % 3) * 5000 - 5000;
+  }
+
+  inline int64_t Size() const
+  {
+    return static_cast<int64_t>(rng_ % 1000 + 1);
+  }
+
+  inline void Append(std::string_view text)
+  {
+    scratch_.append(text);
+  }
+
+  inline void Append(int64_t value)
+  {
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    scratch_.append(digits, result.ptr);
+  }
+
+ private:
+  const std::vector<std::string>& replay_;
+  std::vector<Subscription> subs_;
+  std::size_t next_       = 0;
+  std::size_t replay_pos_ = 0;
+  std::string scratch_;
+  uint64_t rng_  = 88172645463325252ull;
+  int64_t price_ = 87700000;
+};
+
+} // namespace phemex::mock
@@ -0,0 +1,407 @@
+#pragma once
+
+#include <openssl/hmac.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include <boost/beast/http.hpp>
+#include <nlohmann/json.hpp>
+
+#include "common/chrono/time.hpp"
+#include "tools/mock_server/config.hpp"
+
+namespace phemex::mock
+{
+// Order entry endpoints of the contract rest api over one in-memory order
+// book per server. Orders rest until cancelled, none is ever filled. Signed
+// requests are verified if a secret is configured, and counted against the
+// contract rate limit group in windows of a minute if a limit is.
+class RestApi
+{
+ public:
+  using Body     = boost::beast::http::string_body;
+  using Request  = boost::beast::http::request<Body>;
+  using Response = boost::beast::http::response<Body>;
+  using status   = boost::beast::http::status;
+  using verb     = boost::beast::http::verb;
+
+  explicit RestApi(const Config& conf) : conf_{conf}
+  {
+  }
+
+  Response Handle(const Request& request)
+  {
+    const auto target = std::string_view{request.target().data(),
+                                         request.target().size()};
+    const auto mark  = target.find('?');
+    const auto path  = target.substr(0, mark);
+    const auto query = std::string_view::npos == mark
+                           ? std::string_view{}
+                           : target.substr(mark + 1);
+    const auto params = ParseQuery(query);
+
+    if ("/public/time" == path)
+    {
+      return Reply(
+          request, status::ok,
+          {{"serverTime",
+            common::chrono::Time::Now<std::chrono::milliseconds>()}});
+    }
+
+    std::string reason;
+    if (!Verify(request, path, query, reason))
+    {
+      return Error(request, status::unauthorized, 401, reason);
+    }
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (0 != conf_.rate_limit)
+    {
+      auto response = Limit(request);
+      if (status::too_many_requests == response.result())
+      {
+        return response;
+      }
+      auto reply = Route(request, path, params);
+      for (const auto& field : response)
+      {
+        reply.set(field.name_string(), field.value());
+      }
+      return reply;
+    }
+    return Route(request, path, params);
+  }
+
+  // Hex hmac-sha256 the slow and obvious way, to cross-check the signer of
+  // the clients
+  static inline std::string Hmac(
+      std::string_view secret, std::string_view message)
+  {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int size = 0;
+    HMAC(
+        EVP_sha256(), secret.data(), static_cast<int>(secret.size()),
+        reinterpret_cast<const unsigned char*>(message.data()),
+        message.size(), digest, &size);
+
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string hex;
+    for (unsigned int i = 0; i < size; ++i)
+    {
+      hex.push_back(kHex[digest[i] >> 4]);
+      hex.push_back(kHex[digest[i] & 0x0f]);
+    }
+    return hex;
+  }
+
+  // Aop snapshot of the resting orders and one account, no positions
+  std::string AopSnapshot(int64_t sequence)
+  {
+    auto orders = nlohmann::json::array();
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      for (const auto& [id, order] : orders_)
+      {
+        auto row         = order;
+        row["leavesQty"] = order["orderQty"];
+        row["cumQty"]    = 0;
+        row["execQty"]   = 0;
+        orders.push_back(std::move(row));
+      }
+    }
+    return nlohmann::json{
+        {"accounts",
+         nlohmann::json::array(
+             {{{"accountID", 1},
+               {"currency", "BTC"},
+               {"accountBalanceEv", 100000000},
+               {"totalUsedBalanceEv", 0},
+               {"bonusBalanceEv", 0}}})},
+        {"orders", orders},
+        {"positions", nlohmann::json::array()},
+        {"sequence", sequence},
+        {"timestamp", common::chrono::Time::Now<std::chrono::nanoseconds>()},
+        {"type", "snapshot"}}
+        .dump();
+  }
+
+ private:
+  using Params = std::map<std::string, std::string>;
+
+  inline Response Route(
+      const Request& request, std::string_view path, const Params& params)
+  {
+    if (verb::post == request.method() && "/orders" == path)
+    {
+      return Place(request);
+    }
+    if (verb::put == request.method() && "/orders/replace" == path)
+    {
+      return Amend(request, params);
+    }
+    if (verb::delete_ == request.method() && "/orders/cancel" == path)
+    {
+      return Cancel(request, params);
+    }
+    if (verb::delete_ == request.method() && "/orders/all" == path)
+    {
+      return CancelAll(request, params);
+    }
+    if (verb::get == request.method() && "/exchange/order" == path)
+    {
+      return Query(request, params);
+    }
+    if (verb::get == request.method() && "/orders/activeList" == path)
+    {
+      return ActiveList(request, params);
+    }
+    return Error(request, status::not_found, 404, "unknown endpoint");
+  }
+
+  // Count the request in the current window: a 429 with the seconds left of
+  // it once over the limit, else the rate limit headers to add to the reply
+  inline Response Limit(const Request& request)
+  {
+    const auto now = common::chrono::Time::Now<std::chrono::seconds>();
+    if (now >= window_end_)
+    {
+      window_end_ = now + 60;
+      used_       = 0;
+    }
+    if (used_ >= conf_.rate_limit)
+    {
+      auto response =
+          Error(request, status::too_many_requests, 429, "too many requests");
+      response.set(
+          "x-ratelimit-retry-after-contract",
+          std::to_string(window_end_ - now));
+      SetLimit(response);
+      return response;
+    }
+    ++used_;
+    Response response;
+    SetLimit(response);
+    return response;
+  }
+
+  static inline Params ParseQuery(std::string_view query)
+  {
+    Params params;
+    while (!query.empty())
+    {
+      const auto amp  = query.find('&');
+      const auto pair = query.substr(0, amp);
+      const auto eq   = pair.find('=');
+      if (std::string_view::npos != eq)
+      {
+        params[std::string{pair.substr(0, eq)}] =
+            std::string{pair.substr(eq + 1)};
+      }
+      query = std::string_view::npos == amp ? std::string_view{}
+                                            : query.substr(amp + 1);
+    }
+    return params;
+  }
+
+  // Signature over path + query + expiry + body, and an expiry not passed
+  inline bool Verify(
+      const Request& request, std::string_view path, std::string_view query,
+      std::string& reason) const
+  {
+    if (conf_.api_secret.empty())
+    {
+      return true;
+    }
+
+    const auto field     = request["x-phemex-request-expiry"];
+    const auto expiry    = std::string{field.data(), field.size()};
+    const auto signature = request["x-phemex-request-signature"];
+    std::string message{path};
+    message.append(query);
+    message.append(expiry);
+    message.append(request.body());
+
+    if (Hmac(conf_.api_secret, message) !=
+        std::string_view{signature.data(), signature.size()})
+    {
+      reason = "invalid signature";
+      return false;
+    }
+    if (std::atoll(expiry.c_str()) <
+        common::chrono::Time::Now<std::chrono::seconds>())
+    {
+      reason = "request expired";
+      return false;
+    }
+    return true;
+  }
+
+  inline Response Place(const Request& request)
+  {
+    const auto body = nlohmann::json::parse(request.body(), nullptr, false);
+    if (body.is_discarded() || !body.is_object() || !body.contains("symbol") ||
+        !body.contains("clOrdID") || !body.contains("side"))
+    {
+      return Error(request, status::ok, 10001, "invalid order");
+    }
+
+    auto order = nlohmann::json{
+        {"orderID", "mock-" + std::to_string(++next_id_)},
+        {"clOrdID", body["clOrdID"]},
+        {"symbol", body["symbol"]},
+        {"side", body["side"]},
+        {"priceEp", body.value("priceEp", int64_t{0})},
+        {"orderQty", body.value("orderQty", int64_t{0})},
+        {"ordType", body.value("ordType", std::string{"Limit"})},
+        {"ordStatus", "New"},
+        {"actionTimeNs",
+         common::chrono::Time::Now<std::chrono::nanoseconds>()}};
+    orders_[order["orderID"].get<std::string>()] = order;
+    return Reply(request, status::ok, order);
+  }
+
+  inline Response Amend(const Request& request, const Params& params)
+  {
+    auto* order = Find(params);
+    if (!order)
+    {
+      return Error(request, status::ok, 10002, "order not found");
+    }
+    for (const auto* field : {"priceEp", "orderQty"})
+    {
+      const auto it = params.find(field);
+      if (params.end() != it)
+      {
+        (*order)[field] = std::atoll(it->second.c_str());
+      }
+    }
+    (*order)["ordStatus"] = "Replaced";
+    return Reply(request, status::ok, *order);
+  }
+
+  inline Response Cancel(const Request& request, const Params& params)
+  {
+    auto* order = Find(params);
+    if (!order)
+    {
+      return Error(request, status::ok, 10002, "order not found");
+    }
+    auto cancelled         = *order;
+    cancelled["ordStatus"] = "Canceled";
+    orders_.erase(cancelled["orderID"].get<std::string>());
+    return Reply(request, status::ok, cancelled);
+  }
+
+  inline Response CancelAll(const Request& request, const Params& params)
+  {
+    const auto symbol = Param(params, "symbol");
+    int64_t cancelled = 0;
+    for (auto it = orders_.begin(); it != orders_.end();)
+    {
+      if (symbol == it->second["symbol"])
+      {
+        it = orders_.erase(it);
+        ++cancelled;
+      }
+      else
+      {
+        ++it;
+      }
+    }
+    return Reply(request, status::ok, cancelled);
+  }
+
+  inline Response Query(const Request& request, const Params& params)
+  {
+    auto* order = Find(params);
+    if (!order)
+    {
+      return Error(request, status::ok, 10002, "order not found");
+    }
+    return Reply(request, status::ok, nlohmann::json::array({*order}));
+  }
+
+  inline Response ActiveList(const Request& request, const Params& params)
+  {
+    const auto symbol = Param(params, "symbol");
+    auto rows         = nlohmann::json::array();
+    for (const auto& [id, order] : orders_)
+    {
+      if (symbol == order["symbol"])
+      {
+        rows.push_back(order);
+      }
+    }
+    return Reply(request, status::ok, {{"rows", rows}});
+  }
+
+  inline void SetLimit(Response& response) const
+  {
+    response.set(
+        "x-ratelimit-remaining-contract",
+        std::to_string(conf_.rate_limit - used_));
+    response.set(
+        "x-ratelimit-capacity-contract", std::to_string(conf_.rate_limit));
+  }
+
+  inline nlohmann::json* Find(const Params& params)
+  {
+    const auto it = orders_.find(Param(params, "orderID"));
+    if (orders_.end() == it || Param(params, "symbol") != it->second["symbol"])
+    {
+      return nullptr;
+    }
+    return &it->second;
+  }
+
+  static inline std::string Param(const Params& params, const std::string& key)
+  {
+    const auto it = params.find(key);
+    return params.end() == it ? std::string{} : it->second;
+  }
+
+  static inline Response Reply(
+      const Request& request, status code, const nlohmann::json& data)
+  {
+    return MakeResponse(
+        request, code,
+        nlohmann::json{{"code", 0}, {"msg", ""}, {"data", data}}.dump());
+  }
+
+  static inline Response Error(
+      const Request& request, status code, int32_t error,
+      const std::string& message)
+  {
+    return MakeResponse(
+        request, code,
+        nlohmann::json{{"code", error}, {"msg", message}, {"data", nullptr}}
+            .dump());
+  }
+
+  static inline Response MakeResponse(
+      const Request& request, status code, std::string body)
+  {
+    Response response{code, request.version()};
+    response.set(boost::beast::http::field::content_type, "application/json");
+    response.keep_alive(request.keep_alive());
+    response.body() = std::move(body);
+    response.prepare_payload();
+    return response;
+  }
+
+ private:
+  const Config& conf_;
+  std::mutex mutex_;
+  std::map<std::string, nlohmann::json> orders_;
+  uint64_t next_id_ = 0;
+  // end of the current rate limit window, epoch seconds
+  int64_t window_end_ = 0;
+  uint32_t used_      = 0;
+};
+
+} // namespace phemex::mock
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "common/config/io_context_pool.hpp"
+#include "common/log.hpp"
+#include "common/net/io_context_pool.hpp"
+#include "common/net/self_signed_context.hpp"
+#include "tools/mock_server/config.hpp"
+#include "tools/mock_server/session.hpp"
+
+namespace phemex::mock
+{
+// Accepts on the first io_context and spreads sessions over the pool, logs
+// the market data rate every second. Sessions share one rest api.
+class Server
+{
+ public:
+  explicit Server(const Config& conf)
+    : conf_{conf},
+      rest_{conf_},
+      context_{common::net::MakeSelfSignedContext()},
+      sent_{0},
+      pool_{MakePoolConfig(conf)},
+      acceptor_{pool_.At(0),
+                {boost::asio::ip::make_address(conf.address), conf.port}},
+      report_timer_{pool_.At(0)}
+  {
+    if (0 == conf_.batch)
+    {
+      throw std::invalid_argument{"mock server batch should not be 0"};
+    }
+    if (!conf_.replay.empty())
+    {
+      LoadReplay();
+    }
+  }
+
+  Server(const Server&) = delete;
+  Server& operator=(const Server&) = delete;
+
+  ~Server()
+  {
+    Stop();
+  }
+
+  // Serve on the pool threads, returns at once
+  inline void Run()
+  {
+    boost::asio::spawn(
+        pool_.At(0),
+        [this](boost::asio::yield_context yield) { Accept(yield); });
+    boost::asio::spawn(
+        pool_.At(0),
+        [this](boost::asio::yield_context yield) { Report(yield); });
+    pool_.Run();
+  }
+
+  inline void Stop()
+  {
+    pool_.Stop();
+    pool_.Join();
+  }
+
+  inline auto Port() const
+  {
+    return acceptor_.local_endpoint().port();
+  }
+
+  // market data messages sent over all sessions
+  inline auto Sent() const
+  {
+    return sent_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static inline common::config::IOContextPool MakePoolConfig(
+      const Config& conf)
+  {
+    common::config::IOContextPool pool;
+    pool.threads = conf.threads;
+    return pool;
+  }
+
+  inline void LoadReplay()
+  {
+    std::ifstream file{conf_.replay};
+    if (!file)
+    {
+      throw std::runtime_error{"failed to open replay file " + conf_.replay};
+    }
+    for (std::string line; std::getline(file, line);)
+    {
+      if (!line.empty())
+      {
+        replay_.push_back(std::move(line));
+      }
+    }
+    if (replay_.empty())
+    {
+      throw std::runtime_error{"empty replay file " + conf_.replay};
+    }
+  }
+
+  void Accept(boost::asio::yield_context yield)
+  {
+    BOOST_LOG(client_lg) << "mock server listening on "
+                         << acceptor_.local_endpoint();
+    while (true)
+    {
+      boost::system::error_code ec;
+      boost::asio::ip::tcp::socket socket{pool_.Next()};
+      acceptor_.async_accept(socket, yield[ec]);
+      if (ec)
+      {
+        BOOST_LOG_SEV(client_lg, error)
+            << "mock server failed to accept, reason: " << ec.message();
+        return;
+      }
+      socket.set_option(boost::asio::ip::tcp::no_delay{true}, ec);
+      std::make_shared<Session>(
+          std::move(socket), context_, conf_, replay_, rest_, sent_)
+          ->Start();
+    }
+  }
+
+  void Report(boost::asio::yield_context yield)
+  {
+    uint64_t last = 0;
+    while (true)
+    {
+      boost::system::error_code ec;
+      report_timer_.expires_after(std::chrono::seconds{1});
+      report_timer_.async_wait(yield[ec]);
+      if (ec)
+      {
+        return;
+      }
+
+      const auto sent = Sent();
+      if (sent != last)
+      {
+        BOOST_LOG(client_lg) << "mock server sent " << sent - last
+                             << " messages/s, total: " << sent;
+      }
+      last = sent;
+    }
+  }
+
+ private:
+  Config conf_;
+  std::vector<std::string> replay_;
+  // outlive the pool, its sessions refer to them
+  RestApi rest_;
+  boost::asio::ssl::context context_;
+  std::atomic<uint64_t> sent_;
+  common::net::IOContextPool pool_;
+  boost::asio::ip::tcp::acceptor acceptor_;
+  boost::asio::steady_timer report_timer_;
+};
+
+} // namespace phemex::mock
@@ -0,0 +1,392 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <nlohmann/json.hpp>
+
+#include "common/chrono/time.hpp"
+#include "common/log.hpp"
+#include "tools/mock_server/config.hpp"
+#include "tools/mock_server/frame.hpp"
+#include "tools/mock_server/market_data.hpp"
+#include "tools/mock_server/rest_api.hpp"
+
+namespace phemex::mock
+{
+// One client connection. Beast runs the tls and websocket handshakes, then
+// frames are read and written on the tls stream directly so one writer can
+// pack many of them into a single write. A connection whose first request is
+// not a websocket upgrade is served by the rest api until it closes. All work
+// stays on the io_context of the socket.
+class Session : public std::enable_shared_from_this<Session>
+{
+ public:
+  using Stream = boost::beast::websocket::stream<
+      boost::asio::ssl::stream<boost::asio::ip::tcp::socket>>;
+
+  Session(
+      boost::asio::ip::tcp::socket&& socket, boost::asio::ssl::context& context,
+      const Config& conf, const std::vector<std::string>& replay,
+      RestApi& rest, std::atomic<uint64_t>& sent)
+    : ioc_{static_cast<boost::asio::io_context&>(
+          socket.get_executor().context())},
+      ws_{std::move(socket), context},
+      conf_{conf},
+      market_{replay},
+      rest_{rest},
+      sent_{sent},
+      timer_{ioc_}
+  {
+  }
+
+  inline void Start()
+  {
+    boost::asio::spawn(
+        ioc_, [self = shared_from_this()](boost::asio::yield_context yield) {
+          self->Run(yield);
+        });
+  }
+
+ private:
+  void Run(boost::asio::yield_context yield)
+  {
+    boost::system::error_code ec;
+    ws_.next_layer().async_handshake(
+        boost::asio::ssl::stream_base::server, yield[ec]);
+    RestApi::Request request;
+    if (!ec)
+    {
+      boost::beast::http::async_read(
+          ws_.next_layer(), buffer_, request, yield[ec]);
+    }
+    if (!ec && !boost::beast::websocket::is_upgrade(request))
+    {
+      Serve(std::move(request), yield);
+      return;
+    }
+    if (!ec)
+    {
+      ws_.async_accept(request, yield[ec]);
+    }
+    if (ec)
+    {
+      BOOST_LOG_SEV(client_lg, warning)
+          << "mock session handshake failed, reason: " << ec.message();
+      return;
+    }
+
+    boost::asio::spawn(
+        ioc_, [self = shared_from_this()](boost::asio::yield_context yield) {
+          self->Write(yield);
+        });
+    Read(yield);
+  }
+
+  // Answer rest requests until the client or a response closes the
+  // connection
+  void Serve(RestApi::Request request, boost::asio::yield_context yield)
+  {
+    while (true)
+    {
+      const auto response = rest_.Handle(request);
+      boost::system::error_code ec;
+      boost::beast::http::async_write(ws_.next_layer(), response, yield[ec]);
+      if (ec || !response.keep_alive())
+      {
+        break;
+      }
+
+      request = {};
+      boost::beast::http::async_read(
+          ws_.next_layer(), buffer_, request, yield[ec]);
+      if (ec)
+      {
+        break;
+      }
+    }
+    Close();
+  }
+
+  void Read(boost::asio::yield_context yield)
+  {
+    std::string input;
+    char chunk[4096];
+    Frame frame;
+    while (!closed_)
+    {
+      boost::system::error_code ec;
+      const auto bytes = ws_.next_layer().async_read_some(
+          boost::asio::buffer(chunk), yield[ec]);
+      if (ec)
+      {
+        break;
+      }
+
+      input.append(chunk, bytes);
+      std::size_t used = 0;
+      while (const auto size = ParseFrame(
+                 std::string_view{input}.substr(used), frame))
+      {
+        used += size;
+        OnFrame(frame);
+      }
+      input.erase(0, used);
+    }
+    Close();
+  }
+
+  inline void OnFrame(const Frame& frame)
+  {
+    switch (frame.opcode)
+    {
+    case kText:
+      OnRequest(frame.payload);
+      break;
+    case kPing:
+      Reply(kPong, frame.payload);
+      break;
+    case kClose:
+      Reply(kClose, frame.payload.substr(0, 2));
+      closing_ = true;
+      break;
+    default:
+      break;
+    }
+  }
+
+  // json-rpc requests of the market data api, user.auth and aop.subscribe
+  inline void OnRequest(const std::string& payload)
+  {
+    const auto request = nlohmann::json::parse(payload, nullptr, false);
+    if (request.is_discarded() || !request.is_object())
+    {
+      return;
+    }
+
+    const auto id     = request.value("id", int64_t{0});
+    const auto method = request.value("method", std::string{});
+    const auto dot    = method.find('.');
+    const auto topic  = method.substr(0, dot);
+    const auto action = std::string::npos == dot ? "" : method.substr(dot + 1);
+    const auto channel = "orderbook" == topic ? Channel::kOrderBook
+                         : "trade" == topic   ? Channel::kTrade
+                         : "kline" == topic   ? Channel::kKline
+                                              : Channel::kUnknown;
+
+    std::string result;
+    std::string snapshot;
+    if ("server.ping" == method)
+    {
+      result = R"("pong")";
+    }
+    else if ("user.auth" == method && Authenticate(request))
+    {
+      authenticated_ = true;
+      result         = R"({"status":"success"})";
+    }
+    else if ("aop" == topic && authenticated_ && "subscribe" == action)
+    {
+      result   = R"({"status":"success"})";
+      snapshot = rest_.AopSnapshot(++aop_sequence_);
+    }
+    else if ("aop" == topic && "unsubscribe" == action)
+    {
+      result = R"({"status":"success"})";
+    }
+    else if (Channel::kUnknown != channel && "unsubscribe" == action)
+    {
+      market_.Unsubscribe(channel);
+      result = R"({"status":"success"})";
+    }
+    else if (
+        Channel::kUnknown != channel && "subscribe" == action &&
+        request.contains("params") && !request["params"].empty() &&
+        request["params"][0].is_string())
+    {
+      const auto& params = request["params"];
+      const auto interval =
+          params.size() > 1 && params[1].is_number_integer()
+              ? params[1].get<int32_t>()
+              : 60;
+      if (market_.Empty())
+      {
+        paced_ = 0;
+        start_ = std::chrono::steady_clock::now();
+      }
+      market_.Subscribe(channel, params[0].get<std::string>(), interval);
+      result = R"({"status":"success"})";
+    }
+
+    Reply(
+        kText, result.empty()
+                   ? R"({"error":{"code":6001,"message":"invalid argument"},)"
+                     R"("id":)" + std::to_string(id) + R"(,"result":null})"
+                   : R"({"error":null,"id":)" + std::to_string(id) +
+                         R"(,"result":)" + result + "}");
+    if (!snapshot.empty())
+    {
+      Reply(kText, snapshot);
+    }
+  }
+
+  // params ["API", key, hex hmac-sha256 of key + expiry, expiry], checked
+  // if a secret is configured
+  inline bool Authenticate(const nlohmann::json& request) const
+  {
+    const auto params = request.value("params", nlohmann::json::array());
+    if (params.size() < 4 || !params[1].is_string() ||
+        !params[2].is_string() || !params[3].is_number_integer())
+    {
+      return false;
+    }
+    if (conf_.api_secret.empty())
+    {
+      return true;
+    }
+    const auto expiry = params[3].get<int64_t>();
+    return RestApi::Hmac(
+               conf_.api_secret,
+               params[1].get<std::string>() + std::to_string(expiry)) ==
+               params[2].get<std::string>() &&
+           expiry >= common::chrono::Time::Now<std::chrono::seconds>();
+  }
+
+  // Queue a reply ahead of market data and wake the writer
+  inline void Reply(Opcode opcode, std::string_view data)
+  {
+    AppendFrame(replies_, opcode, data);
+    timer_.cancel();
+  }
+
+  void Write(boost::asio::yield_context yield)
+  {
+    std::string output;
+    while (!closed_)
+    {
+      output.clear();
+      output.swap(replies_);
+      if (!closing_)
+      {
+        Produce(output);
+      }
+
+      boost::system::error_code ec;
+      if (output.empty())
+      {
+        if (closing_)
+        {
+          break;
+        }
+        timer_.async_wait(yield[ec]);
+        continue;
+      }
+
+      boost::asio::async_write(
+          ws_.next_layer(), boost::asio::buffer(output), yield[ec]);
+      if (ec || disconnect_)
+      {
+        break;
+      }
+    }
+    Close();
+  }
+
+  // Append the market data frames due by now, arms the timer for the next
+  // one if none is
+  inline void Produce(std::string& output)
+  {
+    if (market_.Empty())
+    {
+      timer_.expires_at(boost::asio::steady_timer::time_point::max());
+      return;
+    }
+
+    uint64_t due = conf_.batch;
+    if (conf_.rate > 0)
+    {
+      const auto elapsed = std::chrono::duration<double>{
+          std::chrono::steady_clock::now() - start_};
+      const auto total = static_cast<uint64_t>(elapsed.count() * conf_.rate);
+      due = std::min<uint64_t>(total - std::min(total, paced_), conf_.batch);
+      if (0 == due)
+      {
+        timer_.expires_at(
+            start_ + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::duration<double>{
+                             (paced_ + 1) / conf_.rate}));
+        return;
+      }
+    }
+
+    const auto now = common::chrono::Time::Now<std::chrono::nanoseconds>();
+    uint64_t produced = 0;
+    while (produced < due && !disconnect_)
+    {
+      ++produced;
+      ++messages_;
+      const auto gap = 0 != conf_.gap_every && 0 == messages_ % conf_.gap_every;
+      market_.Next(output, now, gap);
+      disconnect_ = 0 != conf_.disconnect_after &&
+                    messages_ >= conf_.disconnect_after;
+    }
+    paced_ += produced;
+    sent_.fetch_add(produced, std::memory_order_relaxed);
+  }
+
+  // Drop the connection without a close handshake, the client sees either
+  // the close frame it asked for or a reset
+  inline void Close()
+  {
+    if (closed_)
+    {
+      return;
+    }
+    closed_ = true;
+    timer_.cancel();
+
+    boost::system::error_code ec;
+    auto& socket = ws_.next_layer().next_layer();
+    socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+    socket.close(ec);
+    if (disconnect_)
+    {
+      BOOST_LOG(client_lg) << "mock session disconnected after " << messages_
+                           << " messages";
+    }
+  }
+
+ private:
+  boost::asio::io_context& ioc_;
+  Stream ws_;
+  const Config& conf_;
+  MarketData market_;
+  RestApi& rest_;
+  std::atomic<uint64_t>& sent_;
+  // http requests before the upgrade or of the rest api
+  boost::beast::flat_buffer buffer_;
+  boost::asio::steady_timer timer_;
+  std::string replies_;
+  std::chrono::steady_clock::time_point start_;
+  // market data messages sent, and sent since pacing started
+  uint64_t messages_    = 0;
+  uint64_t paced_       = 0;
+  bool closing_         = false;
+  bool disconnect_      = false;
+  bool closed_          = false;
+  bool authenticated_   = false;
+  int64_t aop_sequence_ = 0;
+};
+
+} // namespace phemex::mock